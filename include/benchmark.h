@@ -0,0 +1,215 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_BENCHMARK_H
+#define PARALLEL_BFS_PROJECT_BENCHMARK_H
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <array>
+#include <ranges>
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <parallel_bfs/search/search_stats.h>
+#include "statistics.h"
+#include "perf_counters.h"
+
+
+/// How many times the Solver runs each algorithm on each problem.
+struct BenchmarkConfig {
+    unsigned int warmup_rounds{0}; ///< Untimed runs of every algorithm before the measured ones (see Solver::warm_cache).
+    unsigned int repetitions{1}; ///< Measured runs of every algorithm.
+    double outlier_threshold{3.5}; ///< Modified z-score above which a run is an outlier (see find_outliers).
+    bool perf_counters{false}; ///< Read the performance counters of every measured run (see PerfCounters).
+    std::optional<std::filesystem::path> tuning_profile{}; ///< Also run the AutoTuned algorithm, and update this profile.
+};
+
+
+inline constexpr std::size_t num_search_metrics = 7;
+
+/// Column names of the search statistics (see parallel_bfs::SearchStats).
+inline constexpr std::array<std::string_view, num_search_metrics> search_metric_keys = {
+        "goal_tests", "expansions", "max_frontier", "handoffs", "busy_ms", "idle_ms", "shutdown_ms"
+};
+
+inline constexpr std::array<std::string_view, num_search_metrics> search_metric_names = {
+        "Goal tests", "Expansions", "Peak frontier", "Handoffs", "Busy time of all threads (ms)", "Idle time of all threads (ms)", "Shutdown time (ms)"
+};
+
+/// Values of the search statistics, in the order of search_metric_keys. The shutdown time is empty if the search
+/// was never told to stop (e.g. there was no solution).
+inline std::array<std::optional<double>, num_search_metrics> search_metric_values(const parallel_bfs::SearchStats &stats) {
+    using ms = std::chrono::duration<double, std::milli>;
+    std::optional<double> shutdown;
+    if (stats.shutdown) shutdown = ms{*stats.shutdown}.count();
+    return {static_cast<double>(stats.goal_tests), static_cast<double>(stats.expansions), static_cast<double>(stats.max_frontier),
+            static_cast<double>(stats.handoffs), ms{stats.busy()}.count(), ms{stats.idle()}.count(), shutdown};
+}
+
+
+/// Statistics of the repeated runs of one algorithm on one problem. Outliers only count for the minimum and the
+/// percentiles, which are robust to them anyway (see Statistic::robust).
+struct SampleSummary {
+    std::size_t runs{0};
+    std::size_t outliers{0};
+    double min{0}, mean{0}, ci95{0}, p50{0}, p90{0}, p99{0};
+
+    explicit SampleSummary(const std::vector<double> &times, const std::vector<bool> &outlier_mask) : runs{times.size()} {
+        std::vector<double> kept;
+        for (std::size_t i = 0; i < times.size(); ++i)
+            if (!outlier_mask[i]) kept.push_back(times[i]);
+        outliers = times.size() - kept.size();
+
+        min = Minimum{}.compute(times);
+        p50 = Percentile<50>{}.compute(times);
+        p90 = Percentile<90>{}.compute(times);
+        p99 = Percentile<99>{}.compute(times);
+        mean = Average{}.compute(kept);
+        ci95 = ConfidenceInterval<95>{}.compute(kept);
+    }
+};
+
+
+/// First number in @problem_name (e.g. 12 for "problem_12.yaml"), or an empty string if there is none.
+inline std::string problem_number(std::string_view problem_name) {
+    const auto begin = std::ranges::find_if(problem_name, [](unsigned char c) { return std::isdigit(c); });
+    const auto end = std::find_if(begin, problem_name.end(), [](unsigned char c) { return !std::isdigit(c); });
+    return std::string{begin, end};
+}
+
+
+/// Delay in microseconds of a spin workload label (e.g. "delay20"), or an empty string for other workloads.
+inline std::string goal_check_delay(std::string_view workload_label) {
+    constexpr std::string_view prefix = "delay";
+    return workload_label.starts_with(prefix) ? std::string{workload_label.substr(prefix.size())} : std::string{};
+}
+
+
+inline std::string json_string(std::string_view text) {
+    std::string result{"\""};
+    for (const char c: text) {
+        if (c == '"' || c == '\\') result += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) result += ' '; // No control characters are expected in names
+        else result += c;
+    }
+    return result + '"';
+}
+
+
+/**
+ * @brief Writes one row per measured run, with the columns of data.csv followed by the repetition, whether the run was
+ * an outlier, the workload label, the metrics of the performance counters and the search statistics (empty if they
+ * were not measured).
+ *
+ * @param measurements Range of Measurement (see Solver::measurements).
+ * @param problem_type Name of the set of problems (e.g. the name of their directory).
+ * @param workload_label Label of the goal-test workload (see WorkloadModel::label).
+ */
+template<std::ranges::input_range Measurements>
+void write_csv(const std::filesystem::path &path, const Measurements &measurements, const std::string &problem_type, const std::string &workload_label) {
+    std::ofstream out{path};
+    out << std::setprecision(9);
+    out << "problem_type,goal_check_delay,problem_number,execution_time,algorithm_name,solution_found,repetition,outlier,workload";
+    for (const auto key: perf_metric_keys) out << ',' << key;
+    for (const auto key: search_metric_keys) out << ',' << key;
+    out << '\n';
+    for (const auto &m: measurements) {
+        out << problem_type << ',' << goal_check_delay(workload_label) << ',' << problem_number(m.problem_name) << ','
+            << m.time.as_milliseconds() << ',' << m.algorithm_name << ',' << (m.solution ? "True" : "False") << ','
+            << m.repetition << ',' << (m.outlier ? "True" : "False") << ',' << workload_label;
+        for (std::size_t i = 0; i < num_perf_metrics; ++i) {
+            out << ',';
+            if (m.counters && m.counters->values[i]) out << *m.counters->values[i];
+        }
+        std::array<std::optional<double>, num_search_metrics> search_values{};
+        if (m.search_stats) search_values = search_metric_values(*m.search_stats);
+        for (const auto &value: search_values) {
+            out << ',';
+            if (value) out << *value;
+        }
+        out << '\n';
+    }
+}
+
+
+/// Writes the benchmark configuration and, for each problem and algorithm, the times of all the runs and their
+/// summary (see SampleSummary). Times are in milliseconds. If the performance counters were read, it also writes the
+/// average of each measured metric over the runs that are not outliers, and the same for the search statistics.
+template<std::ranges::input_range Measurements>
+void write_json(const std::filesystem::path &path, const Measurements &measurements, const BenchmarkConfig &config, const std::string &problem_type, const std::string &workload_label) {
+    std::map<std::pair<std::string, std::string>, std::pair<std::vector<double>, std::vector<bool>>> runs; // Sorted output
+    std::map<std::pair<std::string, std::string>, bool> solved;
+    std::map<std::pair<std::string, std::string>, std::array<std::vector<double>, num_perf_metrics>> counters;
+    std::map<std::pair<std::string, std::string>, std::array<std::vector<double>, num_search_metrics>> search;
+    for (const auto &m: measurements) {
+        if (m.search_stats && !m.outlier) {
+            const auto values = search_metric_values(*m.search_stats);
+            for (std::size_t i = 0; i < num_search_metrics; ++i)
+                if (values[i]) search[{m.problem_name, m.algorithm_name}][i].push_back(*values[i]);
+        }
+        for (std::size_t i = 0; m.counters && !m.outlier && i < num_perf_metrics; ++i)
+            if (m.counters->values[i]) counters[{m.problem_name, m.algorithm_name}][i].push_back(*m.counters->values[i]);
+        auto &[times, outliers] = runs[{m.problem_name, m.algorithm_name}];
+        times.push_back(m.time.as_milliseconds());
+        outliers.push_back(m.outlier);
+        solved[{m.problem_name, m.algorithm_name}] = m.solution != nullptr;
+    }
+
+    std::ofstream out{path};
+    out << std::setprecision(9);
+    out << "{\n  \"problem_type\": " << json_string(problem_type) << ",\n"
+        << "  \"workload\": " << json_string(workload_label) << ",\n"
+        << "  \"warmup_rounds\": " << config.warmup_rounds << ",\n"
+        << "  \"repetitions\": " << config.repetitions << ",\n"
+        << "  \"outlier_threshold\": " << config.outlier_threshold << ",\n"
+        << "  \"results\": [";
+
+    bool first = true;
+    for (const auto &[key, samples]: runs) {
+        const auto &[problem_name, algorithm_name] = key;
+        const SampleSummary summary{samples.first, samples.second};
+        out << (first ? "\n" : ",\n") << "    {\"problem\": " << json_string(problem_name)
+            << ", \"algorithm\": " << json_string(algorithm_name)
+            << ", \"solution_found\": " << (solved[key] ? "true" : "false")
+            << ", \"runs\": " << summary.runs << ", \"outliers\": " << summary.outliers
+            << ", \"min\": " << summary.min << ", \"mean\": " << summary.mean << ", \"ci95\": " << summary.ci95
+            << ", \"p50\": " << summary.p50 << ", \"p90\": " << summary.p90 << ", \"p99\": " << summary.p99
+            << ", \"times\": [";
+        for (std::size_t i = 0; i < samples.first.size(); ++i) out << (i > 0 ? ", " : "") << samples.first[i];
+        out << "]";
+        if (const auto it = counters.find(key); it != counters.end()) {
+            out << ", \"counters\": {";
+            bool first_metric = true;
+            for (std::size_t i = 0; i < num_perf_metrics; ++i) {
+                if (it->second[i].empty()) continue;
+                out << (first_metric ? "" : ", ") << json_string(perf_metric_keys[i]) << ": " << Average{}.compute(it->second[i]);
+                first_metric = false;
+            }
+            out << "}";
+        }
+        if (const auto it = search.find(key); it != search.end()) {
+            out << ", \"search\": {";
+            bool first_metric = true;
+            for (std::size_t i = 0; i < num_search_metrics; ++i) {
+                if (it->second[i].empty()) continue;
+                out << (first_metric ? "" : ", ") << json_string(search_metric_keys[i]) << ": " << Average{}.compute(it->second[i]);
+                first_metric = false;
+            }
+            out << "}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+}
+
+
+#endif //PARALLEL_BFS_PROJECT_BENCHMARK_H
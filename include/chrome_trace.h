@@ -0,0 +1,85 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_CHROME_TRACE_H
+#define PARALLEL_BFS_PROJECT_CHROME_TRACE_H
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <parallel_bfs/search/trace.h>
+#include "benchmark.h"
+
+
+/**
+ * @brief Writes the events recorded during the searches (see parallel_bfs::collect_search_trace) to a JSON file in
+ * Chrome's trace event format, which can be opened with Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Each search is shown as a separate process, named after its label, with one track per thread. Times start at zero
+ * in every search, so that they can be compared with each other. Events are written as soon as they are added, so
+ * the traces of a benchmark are never kept in memory all at once.
+ */
+class ChromeTraceWriter {
+public:
+    explicit ChromeTraceWriter(const std::filesystem::path &path) : _out{path} {
+        _out << std::setprecision(12) << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    }
+
+    ChromeTraceWriter(const ChromeTraceWriter &) = delete;
+
+    ChromeTraceWriter &operator=(const ChromeTraceWriter &) = delete;
+
+    ~ChromeTraceWriter() { _out << "\n]}\n"; }
+
+    /// Adds the events of a search, e.g. with label "problem_1.yaml / WorkStealingBFS #2".
+    void add(const std::string &label, const std::vector<parallel_bfs::ThreadTrace> &traces) {
+        const unsigned int pid = ++_searches;
+        write_metadata(pid, 0, "process_name", "\"name\": " + json_string(label));
+        write_metadata(pid, 0, "process_sort_index", "\"sort_index\": " + std::to_string(pid));
+        for (const auto &thread: traces) {
+            write_metadata(pid, thread.thread_id, "thread_name", "\"name\": " + json_string(thread.thread_name));
+            if (thread.dropped > 0) // The oldest events were overwritten: the track starts later than the search
+                write_event(pid, thread.thread_id, "events dropped", 0.0, std::nullopt, thread.dropped);
+            for (const auto &event: thread.events) {
+                std::optional<double> duration;
+                if (!event.instant()) duration = microseconds(event.duration);
+                write_event(pid, thread.thread_id, event.name, microseconds(event.start), duration, event.arg);
+            }
+        }
+    }
+
+private:
+    [[nodiscard]] static double microseconds(std::chrono::nanoseconds time) { return static_cast<double>(time.count()) / 1e3; }
+
+    void separator() {
+        _out << (_first ? "\n" : ",\n");
+        _first = false;
+    }
+
+    void write_metadata(unsigned int pid, unsigned int tid, const std::string &name, const std::string &args) {
+        separator();
+        _out << "{\"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << tid << ", \"name\": \"" << name << "\", \"args\": {" << args << "}}";
+    }
+
+    /// Complete event ("X") if it has a duration, thread-scoped instant event ("i") otherwise.
+    void write_event(unsigned int pid, unsigned int tid, const char *name, double start, std::optional<double> duration, std::uint64_t arg) {
+        separator();
+        _out << "{\"name\": " << json_string(name) << ", \"ph\": " << (duration ? "\"X\"" : "\"i\", \"s\": \"t\"")
+             << ", \"pid\": " << pid << ", \"tid\": " << tid << ", \"ts\": " << start;
+        if (duration) _out << ", \"dur\": " << *duration;
+        _out << ", \"args\": {\"value\": " << arg << "}}";
+    }
+
+    std::ofstream _out;
+    unsigned int _searches{0};
+    bool _first{true};
+};
+
+
+#endif //PARALLEL_BFS_PROJECT_CHROME_TRACE_H
@@ -0,0 +1,57 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_CONVERT_H
+#define PARALLEL_BFS_PROJECT_CONVERT_H
+
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <parallel_bfs/problem_utils.h>
+#include <parallel_bfs/problems.h>
+#include "solve.h"
+#include "utils.h"
+
+
+/**
+ * @brief Converts the YAML problem files of a directory to the binary format.
+ *
+ * Each "problem*.yaml" file is written next to the original one, with the same name and the extension of the
+ * BinaryWriter. The original files are kept. Once converted, solve() reads the binary files instead, which is much
+ * faster for large problems. Implicit trees (see parallel_bfs::ImplicitTree) store no edges, so they are not converted.
+ *
+ * @param dir The directory containing the problem files.
+ * @param num_problems Optional. The number of problems to convert. If not specified, all problems will be converted.
+ * @note This function does NOT validate if @dir is a valid directory.
+ */
+void convert(const std::filesystem::path &dir, std::optional<unsigned int> num_problems) noexcept(false) {
+    using StateType = parallel_bfs::TreeState<std::uint32_t>; // FIXME: Don't hardcode types
+    using TransitionModelType = parallel_bfs::CsrTree<std::uint32_t>; // FIXME: Don't hardcode types
+
+    const parallel_bfs::YAMLReader<StateType, TransitionModelType> reader;
+    const parallel_bfs::BinaryWriter writer;
+    const auto problem_files = get_problem_files(dir, reader.file_extension, num_problems);
+    if (problem_files.empty()) throw std::runtime_error{"No problem files found in \"" + dir.string() + '"'};
+    if (read_model_type(problem_files.front()) == parallel_bfs::type_name<parallel_bfs::ImplicitTree<std::uint32_t>>()) {
+        std::cout << "[INFO] The problems in " << dir << " use implicit trees, which are already compact. Nothing to convert." << std::endl;
+        return;
+    }
+
+    std::cout << "[INFO] Converting " << problem_files.size() << " problems from " << dir << " to binary format..." << std::endl;
+    auto bar = SimpleProgressBar(problem_files.size() * 2, true);
+
+    for (const auto &file_path : problem_files) {
+        bar.set_status("Reading " + file_path.filename().string());
+        const auto problem = reader.read(file_path);
+        bar.tick();
+
+        auto output_path = file_path;
+        output_path.replace_extension(writer.file_extension);
+        bar.set_status("Writing " + output_path.filename().string());
+        writer.write(problem, output_path);
+        bar.tick();
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_CONVERT_H
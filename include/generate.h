@@ -8,6 +8,10 @@
 #include <filesystem>
 #include <iostream>
 #include <optional>
+#include <random>
+#include <mutex>
+#include <future>
+#include <vector>
 #include <parallel_bfs/problem_utils.h>
 #include <parallel_bfs/problems.h>
 #include "generator_config.h"
@@ -31,36 +35,54 @@ std::string to_padded_string(unsigned int number, int pad_width) {
 }
 
 
-/**
- * @brief Generates random problems and writes them to files.
- *
- * This function generates random problems using a tree generator and writes them to individual files in the specified output directory.
- * The number of problems to generate can be specified, as well as the configuration for the tree generator.
- *
- * @param output_dir The directory where the generated problems will be written.
- * @param num_problems The number of problems to generate. If not specified, 1 problem will be generated.
- * @param config The configuration for the tree generator. If not specified, default values will be used.
- * @note This function does NOT validate if @output_dir is a valid directory.
- */
-void generate(const std::filesystem::path &output_dir, std::optional<unsigned int> num_problems, std::optional<BasicTreeGeneratorConfig> config) {
-    using namespace parallel_bfs;
-    unsigned int n = num_problems.value_or(1);
-    BasicTreeGeneratorConfig c = config.value_or(BasicTreeGeneratorConfig::simple());
+/// Creates a generator of random tree problems (BasicTreeGenerator or ImplicitTreeGenerator) as configured in @c.
+template<typename Generator>
+[[nodiscard]] Generator make_generator(const BasicTreeGeneratorConfig &c) {
+    return c.avg_actions.has_value()
+           ? Generator{c.max_depth, c.goals_depth, c.num_goals, c.avg_actions.value(), c.max_actions}
+           : Generator{c.max_depth, c.goals_depth, c.num_goals, c.min_actions.value(), c.max_actions};
+}
+
+
+/// Number of nodes from which the trees of the problems are generated one at a time. See generate().
+inline constexpr std::size_t large_tree_size = 1'000'000;
+
 
+/// Generates @n problems with @tree_generator and writes them to @output_dir. See generate().
+template<typename Generator>
+void generate_problems(const std::filesystem::path &output_dir, unsigned int n, std::uint64_t seed, Generator tree_generator) {
+    using namespace parallel_bfs;
     const YAMLWriter writer;
-    auto tree_generator =
-        c.avg_actions.has_value()
-        ? BasicTreeGenerator<std::uint32_t>{c.max_depth, c.goals_depth, c.num_goals, c.avg_actions.value(), c.max_actions}
-        : BasicTreeGenerator<std::uint32_t>{c.max_depth, c.goals_depth, c.num_goals, c.min_actions.value(), c.max_actions};
+
+    auto pool = std::make_shared<ThreadPool>();
+    bool concurrent_problems = n >= pool->size();
+    if constexpr (requires { tree_generator.set_thread_pool(pool); tree_generator.expected_size(); }) {
+        // Large trees are generated one at a time, so that only one of them is kept in memory
+        if (tree_generator.expected_size() >= large_tree_size) concurrent_problems = false;
+        if (!concurrent_problems) tree_generator.set_thread_pool(pool);
+    }
 
     std::cout << "[INFO] Generating " << n << " random problems and writing them to " << output_dir << "..." << std::endl;
+    std::cout << "[INFO] Seed: " << seed << std::endl;
     auto bar = SimpleProgressBar(n * 2, true);
+    std::mutex bar_mutex; // Problems may be generated concurrently
+    const auto set_status = [&bar, &bar_mutex](std::string status) {
+        std::lock_guard lock{bar_mutex};
+        bar.set_status(std::move(status));
+    };
+    const auto tick = [&bar, &bar_mutex] {
+        std::lock_guard lock{bar_mutex};
+        bar.tick();
+    };
+
+    const auto make_problem = [&](unsigned int i) {
+        auto generator = tree_generator; // Each thread needs its own random engine
+        const std::uint64_t problem_seed = detail::mix64(seed + i);
 
-    for (unsigned int i = 0; i < n; ++i) {
         // Create random problem
-        bar.set_status("Creating random problem " + std::to_string(i));
-        const auto problem = tree_generator.make_problem();
-        bar.tick();
+        set_status("Creating random problem " + std::to_string(i));
+        const auto problem = generator.make_problem(problem_seed);
+        tick();
 
         // Build file path to write the problem to
         std::string padded_string = to_padded_string(i, static_cast<int>(std::to_string(n-1).length()));
@@ -69,10 +91,49 @@ void generate(const std::filesystem::path &output_dir, std::optional<unsigned in
         const auto output_path = output_dir / filename;
 
         // Write the problem
-        bar.set_status("Writing " + output_path.filename().string());
+        set_status("Writing " + output_path.filename().string());
         writer.write(problem, output_path);
-        bar.tick();
+        tick();
+    };
+
+    if (concurrent_problems) {
+        std::vector<std::future<void>> futures;
+        futures.reserve(n);
+        for (unsigned int i = 0; i < n; ++i) futures.push_back(pool->submit(make_problem, i));
+        for (auto &future: futures) future.wait();
+        for (auto &future: futures) future.get();
+    } else {
+        for (unsigned int i = 0; i < n; ++i) make_problem(i);
     }
 }
 
+
+/**
+ * @brief Generates random problems and writes them to files.
+ *
+ * This function generates random problems using a tree generator and writes them to individual files in the specified output directory.
+ * The number of problems to generate can be specified, as well as the configuration for the tree generator.
+ *
+ * Problems are generated in parallel: concurrently, one per thread, when there are at least as many problems as
+ * threads and their trees are small, and otherwise one at a time with the tree of each problem split among the
+ * threads (so that large trees are not kept in memory at the same time). Problem i is always
+ * generated from a seed derived from the seed of the configuration and i, so the output does not depend on the
+ * number of threads.
+ *
+ * @param output_dir The directory where the generated problems will be written.
+ * @param num_problems The number of problems to generate. If not specified, 1 problem will be generated.
+ * @param config The configuration for the tree generator. If not specified, default values will be used. If it
+ * asks for implicit trees, only the seed and the parameters of each tree are written.
+ * @note This function does NOT validate if @output_dir is a valid directory.
+ */
+void generate(const std::filesystem::path &output_dir, std::optional<unsigned int> num_problems, std::optional<BasicTreeGeneratorConfig> config) {
+    using namespace parallel_bfs;
+    unsigned int n = num_problems.value_or(1);
+    BasicTreeGeneratorConfig c = config.value_or(BasicTreeGeneratorConfig::simple());
+    const std::uint64_t seed = c.seed.has_value() ? c.seed.value() : std::random_device{}();
+
+    if (c.implicit) generate_problems(output_dir, n, seed, make_generator<ImplicitTreeGenerator<std::uint32_t>>(c));
+    else generate_problems(output_dir, n, seed, make_generator<BasicTreeGenerator<std::uint32_t>>(c));
+}
+
 #endif //PARALLEL_BFS_PROJECT_GENERATE_H
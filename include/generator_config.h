@@ -9,6 +9,7 @@
 #include <fstream>
 #include <string>
 #include <optional>
+#include <cstdint>
 #include <yaml-cpp/yaml.h>
 
 
@@ -20,6 +21,8 @@ struct BasicTreeGeneratorConfig {
     std::optional<double> avg_actions{std::nullopt};
     std::optional<unsigned int> min_actions{std::nullopt};
     unsigned int max_actions{1};
+    std::optional<std::uint64_t> seed{std::nullopt}; ///< Base seed of the problems. Random if not specified.
+    bool implicit{false}; ///< Generate ImplicitTree problems, whose edges are computed during the search.
 
     [[nodiscard]] static BasicTreeGeneratorConfig simple() {
         return BasicTreeGeneratorConfig{6, 6, 10, 2, 0, 4};
@@ -49,6 +52,8 @@ struct BasicTreeGeneratorConfig {
     auto avg_actions = node["avg_actions"].as<std::optional<double>>(std::nullopt);
     auto min_actions = node["min_actions"].as<std::optional<unsigned int>>(std::nullopt);
     auto max_actions = node["max_actions"].as<unsigned int>();
+    auto seed = node["seed"].as<std::optional<std::uint64_t>>(std::nullopt);
+    auto implicit = node["implicit"].as<bool>(false);
 
     // Validate the parsed values
     if (avg_actions.has_value() && min_actions.has_value())
@@ -56,7 +61,7 @@ struct BasicTreeGeneratorConfig {
     if (!avg_actions.has_value() && !min_actions.has_value())
         throw std::invalid_argument("Either avg_actions or min_actions must be specified.");
 
-    return BasicTreeGeneratorConfig{max_depth, goals_depth, num_goals, avg_actions, min_actions, max_actions};
+    return BasicTreeGeneratorConfig{max_depth, goals_depth, num_goals, avg_actions, min_actions, max_actions, seed, implicit};
 }
 
 
@@ -0,0 +1,248 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_PERF_COUNTERS_H
+#define PARALLEL_BFS_PROJECT_PERF_COUNTERS_H
+
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+
+/// Metrics measured by PerfCounters for each run of an algorithm.
+enum class PerfMetric : std::size_t {
+    CpuTime,          ///< CPU time of all the threads, in milliseconds
+    MaxThreadCpuTime, ///< CPU time of the busiest thread, in milliseconds
+    Cycles,
+    Instructions,
+    LlcMisses,        ///< Misses of the last level cache
+    BranchMisses,
+    ContextSwitches,
+};
+
+inline constexpr std::size_t num_perf_metrics = 7;
+
+/// Column names (e.g. in CSV files).
+inline constexpr std::array<std::string_view, num_perf_metrics> perf_metric_keys = {
+        "cpu_time_ms", "max_thread_cpu_time_ms", "cycles", "instructions", "llc_misses", "branch_misses", "context_switches"
+};
+
+/// Names for humans (e.g. in the results summary).
+inline constexpr std::array<std::string_view, num_perf_metrics> perf_metric_names = {
+        "CPU time (ms)", "CPU time of the busiest thread (ms)", "Cycles", "Instructions", "LLC misses", "Branch misses", "Context switches"
+};
+
+
+/// Values of the metrics of one run. Metrics that could not be measured are empty.
+struct PerfSample {
+    std::array<std::optional<double>, num_perf_metrics> values{};
+
+    [[nodiscard]] std::optional<double> operator[](PerfMetric metric) const { return values[static_cast<std::size_t>(metric)]; }
+
+    std::optional<double> &operator[](PerfMetric metric) { return values[static_cast<std::size_t>(metric)]; }
+};
+
+
+/**
+ * @brief Reads hardware and software performance counters (Linux's perf_event_open) around a run of an algorithm.
+ *
+ * Counters are opened for every thread of the process, and the list of threads is updated at each start(), so threads
+ * created since the previous run (e.g. by TBB) are counted too. Threads created during a run are counted once they exit,
+ * through the inherit flag of the counters of the thread that created them. Each counter is opened on its own, so that a
+ * missing one (e.g. hardware counters in most virtual machines, or all of them with a strict perf_event_paranoid) does
+ * not prevent the rest. Kernel-mode events are counted when allowed; otherwise, hardware counters fall back to user mode.
+ *
+ * CPU times do not need perf_event_open: the total is the CPU time of the process, and the busiest thread is found
+ * with the CPU clocks of the threads (on Linux only).
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+        _available.fill(true);
+#ifdef __linux__
+        update_threads();
+#else
+        for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i) _available[i] = false;
+        _available[static_cast<std::size_t>(PerfMetric::MaxThreadCpuTime)] = false;
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const auto &thread: _threads) close_counters(thread);
+#endif
+    }
+
+    /// Resets and starts all the counters.
+    void start() {
+#ifdef __linux__
+        update_threads();
+        for (auto &thread: _threads) {
+            for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i) {
+                if (!_available[i]) continue;
+                ioctl(thread.fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(thread.fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+            thread.cpu_start = thread_cpu_ms(thread.tid);
+        }
+#endif
+        _process_cpu_start = std::clock();
+    }
+
+    /// Stops all the counters and returns their values since the last start().
+    [[nodiscard]] PerfSample stop() {
+        PerfSample sample;
+        const std::clock_t process_cpu_end = std::clock();
+        if (_process_cpu_start != static_cast<std::clock_t>(-1) && process_cpu_end != static_cast<std::clock_t>(-1))
+            sample[PerfMetric::CpuTime] = 1000.0 * static_cast<double>(process_cpu_end - _process_cpu_start) / CLOCKS_PER_SEC;
+#ifdef __linux__
+        for (auto &thread: _threads) {
+            for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i) {
+                if (_available[i]) ioctl(thread.fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+
+        std::optional<double> max_cpu{0.0};
+        for (const auto &thread: _threads) {
+            const auto cpu_end = thread_cpu_ms(thread.tid);
+            if (max_cpu && cpu_end && thread.cpu_start) max_cpu = std::max(*max_cpu, *cpu_end - *thread.cpu_start);
+            else max_cpu.reset();
+
+            for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i) {
+                if (!_available[i]) continue;
+                const auto value = read_counter(thread.fds[i]);
+                if (!value) _available[i] = false; // Something went wrong: stop reporting this counter
+                else sample.values[i] = sample.values[i].value_or(0.0) + *value;
+            }
+        }
+        if (_available[static_cast<std::size_t>(PerfMetric::MaxThreadCpuTime)]) sample[PerfMetric::MaxThreadCpuTime] = max_cpu;
+        for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i)
+            if (!_available[i]) sample.values[i].reset();
+#endif
+        return sample;
+    }
+
+    /// Names of the metrics that are measured, or "none".
+    [[nodiscard]] std::string available_metrics() const {
+        std::string result;
+        for (std::size_t i = 0; i < num_perf_metrics; ++i)
+            if (_available[i]) result += (result.empty() ? "" : ", ") + std::string{perf_metric_keys[i]};
+        return result.empty() ? "none" : result;
+    }
+
+    /// Whether the counter of @metric could be opened for all threads.
+    [[nodiscard]] bool available(PerfMetric metric) const { return _available[static_cast<std::size_t>(metric)]; }
+
+private:
+    static constexpr std::size_t first_perf_metric = static_cast<std::size_t>(PerfMetric::Cycles); // The rest are not perf events
+
+    struct ThreadCounters {
+#ifdef __linux__
+        pid_t tid;
+#else
+        int tid;
+#endif
+        std::array<int, num_perf_metrics> fds;
+        std::optional<double> cpu_start{};
+    };
+
+#ifdef __linux__
+    /// Opens the counters of the threads created since the last call, and closes those of the threads that exited.
+    void update_threads() {
+        std::vector<pid_t> tids;
+        std::error_code error;
+        for (std::filesystem::directory_iterator it{"/proc/self/task", error}, end; !error && it != end; it.increment(error))
+            tids.push_back(static_cast<pid_t>(std::stol(it->path().filename().string())));
+
+        std::erase_if(_threads, [&tids](const ThreadCounters &thread) {
+            if (std::ranges::find(tids, thread.tid) != tids.end()) return false;
+            close_counters(thread);
+            return true;
+        });
+        for (const pid_t tid: tids) {
+            if (std::ranges::find(_threads, tid, &ThreadCounters::tid) != _threads.end()) continue;
+            ThreadCounters thread{tid, {}};
+            thread.fds.fill(-1);
+            for (std::size_t i = first_perf_metric; i < num_perf_metrics; ++i) {
+                if (_available[i]) thread.fds[i] = open_counter(static_cast<PerfMetric>(i), tid);
+                if (thread.fds[i] < 0) _available[i] = false; // Only counted if it can be counted in all the threads
+            }
+            _threads.push_back(thread);
+        }
+    }
+
+    static void close_counters(const ThreadCounters &thread) {
+        for (const int fd: thread.fds)
+            if (fd >= 0) ::close(fd);
+    }
+
+    /// Opens a disabled counter of @metric for thread @tid. Returns -1 if it is not available.
+    [[nodiscard]] static int open_counter(PerfMetric metric, pid_t tid) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.type = metric == PerfMetric::ContextSwitches ? PERF_TYPE_SOFTWARE : PERF_TYPE_HARDWARE;
+        switch (metric) {
+            case PerfMetric::Cycles: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case PerfMetric::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case PerfMetric::LlcMisses: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case PerfMetric::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            case PerfMetric::ContextSwitches: attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES; break;
+            default: return -1;
+        }
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+        if (fd < 0 && metric != PerfMetric::ContextSwitches) { // Context switches happen in kernel mode: all or nothing
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+        }
+        return fd;
+    }
+
+    /// Value of the counter, scaled up if the kernel had to multiplex it with other counters.
+    [[nodiscard]] static std::optional<double> read_counter(int fd) {
+        std::uint64_t data[3]; // value, time enabled, time running
+        if (::read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) return std::nullopt;
+        if (data[2] == 0) return data[1] == 0 ? std::optional<double>{0.0} : std::nullopt;
+        return static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    }
+
+    /// CPU time of thread @tid of this process, in milliseconds. Uses the CPU clock id that glibc builds for
+    /// pthread_getcpuclockid (the pool does not expose its pthread handles).
+    [[nodiscard]] static std::optional<double> thread_cpu_ms(pid_t tid) {
+        const auto clock = static_cast<clockid_t>((~static_cast<unsigned int>(tid) << 3) | 6); // CPUCLOCK_SCHED | PERTHREAD
+        timespec time{};
+        if (clock_gettime(clock, &time) != 0) return std::nullopt;
+        return static_cast<double>(time.tv_sec) * 1e3 + static_cast<double>(time.tv_nsec) * 1e-6;
+    }
+#endif
+
+    std::vector<ThreadCounters> _threads{};
+    std::array<bool, num_perf_metrics> _available{};
+    std::clock_t _process_cpu_start{0};
+};
+
+
+#endif //PARALLEL_BFS_PROJECT_PERF_COUNTERS_H
@@ -7,6 +7,9 @@
 
 #include <filesystem>
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
 #include <optional>
 #include <vector>
 #include <ranges>
@@ -15,6 +18,7 @@
 #include <parallel_bfs/search.h>
 #include "utils.h"
 #include "solver.h"
+#include "tuning_profile.h"
 
 
 /**
@@ -55,9 +59,10 @@ std::vector<std::filesystem::path> get_problem_files(const std::filesystem::path
  * file path is returned.
  *
  * @param input_dir The input directory path where the log file will be placed.
+ * @param workload_label Label of the goal-test workload, e.g. "delay20" (see WorkloadModel::label).
  * @return The path to the log file.
  */
-std::filesystem::path get_log_path(const std::filesystem::path &input_dir, std::chrono::microseconds delay) {
+std::filesystem::path get_log_path(const std::filesystem::path &input_dir, const std::string &workload_label) {
     // Get current time
     auto now = std::chrono::system_clock::now();
     std::time_t current_time = std::chrono::system_clock::to_time_t(now);
@@ -65,7 +70,7 @@ std::filesystem::path get_log_path(const std::filesystem::path &input_dir, std::
 
     // Convert time to compact string
     std::stringstream file_name;
-    file_name << "results_delay" << delay.count() << "_";
+    file_name << "results_" << workload_label << "_";
     file_name << std::put_time(time_info, "%Y-%m-%d-%H:%M:%S"); // Compact datetime format
     file_name << ".log";
 
@@ -77,61 +82,110 @@ std::filesystem::path get_log_path(const std::filesystem::path &input_dir, std::
 /**
  * @brief Logs the results of the Solver.
  *
- * This function logs the results of the Solver to a file in the given input directory.
+ * This function logs the results of the Solver to a file in the given input directory, next to a CSV file with one
+ * row per run (see write_csv) and a JSON file with the statistics of each problem and algorithm (see write_json).
  * It also prints a performance statistics summary to the console.
  *
  * @tparam State The searchable state type.
  * @tparam TM The transition model type.
+ * @param log_path The log file (see get_log_path).
  * @param input_dir The input directory path.
  * @param solver The Solver object.
  */
 template<parallel_bfs::Searchable State, std::derived_from<parallel_bfs::BaseTransitionModel<State>> TM>
-void log_results(const std::filesystem::path &input_dir, const Solver<State, TM> &solver, std::chrono::microseconds delay) {
-    auto log_path = get_log_path(input_dir, delay);
+void log_results(const std::filesystem::path &log_path, const std::filesystem::path &input_dir, const Solver<State, TM> &solver, const std::string &workload_label) {
     std::ofstream log_stream{log_path};
-    const auto stats = solver.template statistics_summary<Average, Median, StandardDeviation>();
+    const auto stats = solver.template statistics_summary<Average, ConfidenceInterval<95>, Median, StandardDeviation, Minimum, Percentile<90>, Percentile<99>>();
     log_stream << solver.results() << "\n[INFO] Results summary:\n" << stats;
+
+    const std::string problem_type = input_dir.filename().string();
+    write_csv(std::filesystem::path{log_path}.replace_extension(".csv"), solver.measurements(), problem_type, workload_label);
+    write_json(std::filesystem::path{log_path}.replace_extension(".json"), solver.measurements(), solver.config(), problem_type, workload_label);
+
     std::cout << "\n[INFO] Results summary:\n" << stats << "\n";
-    std::cout << "[INFO] Detailed results logged in " << log_path << "." << std::endl;
+    std::cout << "[INFO] Detailed results logged in " << log_path << " (and in .csv and .json files with the same name)." << std::endl;
+    if constexpr (parallel_bfs::search_trace_enabled)
+        std::cout << "[INFO] Timeline of every run written to " << std::filesystem::path{log_path}.replace_extension(".trace.json") << " (open it with https://ui.perfetto.dev)." << std::endl;
 }
 
 
 /**
- * @brief Solve a set of problems using various algorithms.
+ * @brief Reads the type of the transition model of a YAML problem file without parsing the whole file.
  *
- * Given an input directory and an optional number of problems to solve, this function reads the problem files
- * from the directory, solves each problem using multiple algorithms, and logs the results.
+ * @param file_path The problem file, written by YAMLWriter.
+ * @return The type name stored in the header of the file, or an empty string if it is not found.
+ */
+std::string read_model_type(const std::filesystem::path &file_path) {
+    constexpr std::string_view key = "transition model type: ";
+    std::ifstream input{file_path};
+    std::string line;
+    for (int i = 0; i < 8 && std::getline(input, line); ++i) {
+        if (const auto pos = line.find(key); pos != std::string::npos) return line.substr(pos + key.size());
+    }
+    return {};
+}
+
+
+/**
+ * @brief Solves a list of problem files using various algorithms and logs the results.
  *
+ * @tparam State The searchable state type.
+ * @tparam TM The transition model type.
  * @param input_dir The directory containing the problem files.
- * @param num_problems Optional. The number of problems to solve. If not specified, all problems will be solved.
- * @note This function does NOT validate if @input_dir is a valid directory.
+ * @param problem_files The problem files to solve.
+ * @param reader Reader of the problem files (e.g. YAMLReader or BinaryReader).
+ * @param workload Cost model of the goal test. If null, goal tests have no artificial cost.
+ * @param placement Placement of the threads used by the parallel algorithms.
+ * @param benchmark Number of warm-up and measured runs of each algorithm, whether to read performance counters, and
+ * the tuning profile of the AutoTuned algorithm (if any), which is updated with the results.
  */
-void solve(const std::filesystem::path &input_dir, std::optional<unsigned int> num_problems, std::optional<std::chrono::microseconds> workload_delay) noexcept(false) {
-    using StateType = parallel_bfs::TreeState<std::uint32_t>; // FIXME: Don't hardcode types
-    using TransitionModelType = parallel_bfs::BasicTree<std::uint32_t>; // FIXME: Don't hardcode types
-
-    // Define delay for goal-checking
-    std::chrono::microseconds delay = workload_delay.value_or(std::chrono::microseconds{0});
-
-    // Create solver and add algorithms
-    Solver<StateType , TransitionModelType> solver;
-    solver.add_algorithm(parallel_bfs::sync_bfs<StateType, TransitionModelType>, "SyncBFS");
-    solver.add_algorithm(parallel_bfs::tasks_bfs<StateType, TransitionModelType>, "TasksBFS");
-    solver.add_algorithm(parallel_bfs::async_start_bfs<StateType, TransitionModelType>, "AsyncStartBFS");
-    // solver.add_algorithm(parallel_bfs::async_bfs<StateType, TransitionModelType>, "AsyncBFS"); // Very slow
-    // solver.add_algorithm(parallel_bfs::foreach_start_bfs<StateType, TransitionModelType>, "ForeachStartBFS");
-    // solver.add_algorithm(parallel_bfs::foreach_bfs<StateType, TransitionModelType>, "ForeachBFS"); // Very slow
-    // solver.add_algorithm(parallel_bfs::any_of_bfs<StateType, TransitionModelType>, "AnyOfBFS");
-    solver.add_algorithm(parallel_bfs::multithread_bfs<StateType, TransitionModelType>, "MultithreadBFS");
-
-    // Create reader
-    const parallel_bfs::YAMLReader<StateType, TransitionModelType> reader;
-    const auto problem_files = get_problem_files(input_dir, reader.file_extension, num_problems);
-    if (problem_files.empty()) throw std::runtime_error{"No problem files found in \"" + input_dir.string() + '"'};
+template<parallel_bfs::Searchable State, std::derived_from<parallel_bfs::BaseTransitionModel<State>> TM, typename Reader>
+void solve_files(const std::filesystem::path &input_dir, const std::vector<std::filesystem::path> &problem_files, const Reader &reader, const std::shared_ptr<const parallel_bfs::WorkloadModel> &workload, parallel_bfs::PlacementPolicy placement, const BenchmarkConfig &benchmark) {
+    // Define the cost of goal-checking
+    const std::string workload_label = workload ? workload->label() : "delay0";
+    const auto log_path = get_log_path(input_dir, workload_label);
+
+    // Create solver and add algorithms. Parallel algorithms share the thread pool of the solver.
+    using ProblemType = parallel_bfs::Problem<State, TM>;
+    using parallel_bfs::ThreadPool;
+    Solver<State, TM> solver{std::thread::hardware_concurrency(), placement, benchmark};
+    solver.set_trace_output(std::filesystem::path{log_path}.replace_extension(".trace.json"));
+    std::shared_ptr<parallel_bfs::TuningProfile> profile{nullptr};
+    if (benchmark.tuning_profile.has_value()) {
+        profile = std::make_shared<parallel_bfs::TuningProfile>(read_tuning_profile(benchmark.tuning_profile.value()));
+        solver.enable_tuning(profile);
+    }
+    solver.add_algorithm(parallel_bfs::sync_bfs<State, TM>, "SyncBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::tasks_bfs(p, pool); }, "TasksBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::async_start_bfs(p, pool); }, "AsyncStartBFS");
+    // solver.add_algorithm(parallel_bfs::async_bfs<State, TM>, "AsyncBFS"); // Very slow
+    // solver.add_algorithm(parallel_bfs::foreach_start_bfs<State, TM>, "ForeachStartBFS");
+    // solver.add_algorithm(parallel_bfs::foreach_bfs<State, TM>, "ForeachBFS"); // Very slow
+    // solver.add_algorithm(parallel_bfs::any_of_bfs<State, TM>, "AnyOfBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::multithread_bfs(p, pool); }, "MultithreadBFS");
+    solver.add_algorithm(parallel_bfs::arena_sync_bfs<State, TM>, "ArenaSyncBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::arena_tasks_bfs(p, pool); }, "ArenaTasksBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::work_stealing_bfs(p, pool); }, "WorkStealingBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::level_sync_bfs(p, pool); }, "LevelSyncBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::shared_queue_bfs(p, pool); }, "SharedQueueBFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::locked_queue_bfs(p, pool); }, "LockedQueueBFS");
+    solver.add_algorithm(parallel_bfs::uniform_cost_search<State, TM>, "UniformCostSearch");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::hda_star_search(p, pool); }, "HDAStar");
+    solver.add_algorithm([](const ProblemType &p) { return parallel_bfs::iddfs(p); }, "IDDFS");
+    solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::iddfs(p, pool); }, "ParallelIDDFS");
+    if constexpr (parallel_bfs::detail::ReversibleGraph<TM, State>) { // Needs a graph that can list predecessors
+        solver.add_algorithm([](const ProblemType &p) { return parallel_bfs::bidirectional_bfs(p); }, "BidirectionalBFS");
+        solver.add_algorithm([](const ProblemType &p, ThreadPool &pool) { return parallel_bfs::bidirectional_bfs(p, pool); }, "ParallelBidirectionalBFS");
+    }
 
     // Solve all problems with all algorithms
     std::cout << "\n[INFO] Solving " << problem_files.size() << " problems from " << input_dir << " ...\n";
-    std::cout << "[INFO] Workload (goal test) delay: " << delay << "\n";
+    std::cout << "[INFO] Workload (goal test): " << workload_label << "\n";
+    std::cout << "[INFO] Runs of each algorithm per problem: " << benchmark.warmup_rounds << " warm-up, " << benchmark.repetitions << " measured\n";
+    std::cout << "[INFO] Search statistics: " << (parallel_bfs::search_stats_enabled ? "enabled" : "disabled (build with PARALLEL_BFS_ENABLE_STATS)") << "\n";
+    std::cout << "[INFO] Search timeline: " << (parallel_bfs::search_trace_enabled ? "enabled" : "disabled (build with PARALLEL_BFS_ENABLE_TRACE)") << "\n";
+    if (benchmark.perf_counters) std::cout << "[INFO] Performance counters: " << solver.available_counters() << "\n";
+    if (profile) std::cout << "[INFO] Tuning profile: " << benchmark.tuning_profile.value() << " (" << profile->problems().size() << " kinds of problems)\n";
     std::cout << "[INFO] CPU cores available: " << std::thread::hardware_concurrency() << std::endl;
     auto bar = SimpleProgressBar(problem_files.size() * 3, true);
 
@@ -149,12 +203,54 @@ void solve(const std::filesystem::path &input_dir, std::optional<unsigned int> n
         bar.tick();
 
         bar.set_status("Solving " + file_name);
-        problem.set_workload_delay(delay);
+        problem.set_workload(workload);
         solver.solve(problem, file_name);
         bar.tick();
     }
 
-    log_results(input_dir, solver, delay);
+    log_results(log_path, input_dir, solver, workload_label);
+    if (profile) {
+        write_tuning_profile(benchmark.tuning_profile.value(), *profile);
+        std::cout << "[INFO] Tuning profile updated in " << benchmark.tuning_profile.value() << "." << std::endl;
+    }
+}
+
+
+/**
+ * @brief Solve a set of problems using various algorithms.
+ *
+ * Given an input directory and an optional number of problems to solve, this function reads the problem files
+ * from the directory, solves each problem using multiple algorithms, and logs the results. If the directory contains
+ * binary problem files, they are read instead of the YAML ones. The transition model of YAML problems is chosen by
+ * the type stored in the first file, so all the problems of a directory must have the same type.
+ *
+ * @param input_dir The directory containing the problem files.
+ * @param num_problems Optional. The number of problems to solve. If not specified, all problems will be solved.
+ * @param workload Cost model of the goal test. If null, goal tests have no artificial cost.
+ * @param placement Placement of the threads used by the parallel algorithms.
+ * @param benchmark Number of warm-up and measured runs of each algorithm, and whether to read performance counters.
+ * @note This function does NOT validate if @input_dir is a valid directory.
+ */
+void solve(const std::filesystem::path &input_dir, std::optional<unsigned int> num_problems, const std::shared_ptr<const parallel_bfs::WorkloadModel> &workload, parallel_bfs::PlacementPolicy placement = parallel_bfs::PlacementPolicy::Compact, const BenchmarkConfig &benchmark = {}) noexcept(false) {
+    using StateType = parallel_bfs::TreeState<std::uint32_t>; // FIXME: Don't hardcode types
+    using TreeType = parallel_bfs::CsrTree<std::uint32_t>;
+    using ImplicitTreeType = parallel_bfs::ImplicitTree<std::uint32_t>;
+
+    // Binary problem files (see convert()) are preferred, since they are loaded without parsing.
+    const parallel_bfs::BinaryReader<StateType, TreeType> binary_reader;
+    auto problem_files = get_problem_files(input_dir, binary_reader.file_extension, num_problems);
+    if (!problem_files.empty()) return solve_files<StateType, TreeType>(input_dir, problem_files, binary_reader, workload, placement, benchmark);
+
+    const parallel_bfs::YAMLReader<StateType, TreeType> yaml_reader;
+    problem_files = get_problem_files(input_dir, yaml_reader.file_extension, num_problems);
+    if (problem_files.empty()) throw std::runtime_error{"No problem files found in \"" + input_dir.string() + '"'};
+
+    if (read_model_type(problem_files.front()) == parallel_bfs::type_name<ImplicitTreeType>()) {
+        const parallel_bfs::YAMLReader<StateType, ImplicitTreeType> implicit_reader;
+        solve_files<StateType, ImplicitTreeType>(input_dir, problem_files, implicit_reader, workload, placement, benchmark);
+    } else {
+        solve_files<StateType, TreeType>(input_dir, problem_files, yaml_reader, workload, placement, benchmark);
+    }
 }
 
 #endif //PARALLEL_BFS_PROJECT_SOLVE_H
@@ -12,9 +12,19 @@
 #include <random>
 #include <functional>
 #include <ranges>
+#include <memory>
+#include <array>
+#include <optional>
+#include <numeric>
+#include <thread>
+#include <string>
+#include <string_view>
 #include <parallel_bfs/search.h>
 #include "utils.h"
 #include "statistics.h"
+#include "benchmark.h"
+#include "perf_counters.h"
+#include "chrome_trace.h"
 
 
 template<parallel_bfs::Searchable State>
@@ -48,6 +58,16 @@ concept BfsCallable = requires(F&& f, const parallel_bfs::Problem<State, TM> &pr
 };
 
 
+/// Parallel strategies that run on a thread pool provided by the caller.
+template<typename F, typename State, typename TM>
+concept PooledBfsCallable = requires(F&& f, const parallel_bfs::Problem<State, TM> &problem, parallel_bfs::ThreadPool &pool) {
+    requires parallel_bfs::Searchable<State>;
+    requires std::derived_from<TM, parallel_bfs::BaseTransitionModel<State>>;
+    requires std::invocable<F, const parallel_bfs::Problem<State, TM> &, parallel_bfs::ThreadPool &>;
+    { std::invoke(std::forward<F>(f), problem, pool) } -> std::same_as<std::shared_ptr<parallel_bfs::Node<State>>>;
+};
+
+
 template<parallel_bfs::Searchable State, std::derived_from<parallel_bfs::BaseTransitionModel<State>> TM>
 struct BfsAlgorithm {
     std::function<std::shared_ptr<parallel_bfs::Node<State>>(const parallel_bfs::Problem<State, TM>&)> algorithm;
@@ -61,25 +81,122 @@ struct Measurement {
     std::string algorithm_name;
     ExecutionTime time;
     std::shared_ptr<parallel_bfs::Node<State>> solution;
+    unsigned int repetition{0};
+    bool outlier{false}; ///< Compared with the other repetitions of the same algorithm on the same problem
+    std::optional<PerfSample> counters{}; ///< Only if BenchmarkConfig::perf_counters is set
+    std::optional<parallel_bfs::SearchStats> search_stats{}; ///< Only if built with PARALLEL_BFS_ENABLE_STATS
+    std::optional<parallel_bfs::TuningChoice> tuning{}; ///< Choice of the AutoTuned algorithm, if it made one
 };
 
 
 template<parallel_bfs::Searchable State, std::derived_from<parallel_bfs::BaseTransitionModel<State>> TM>
 class Solver {
 public:
+    /// The thread pool is created once and shared by all the pooled algorithms, so that thread creation is not
+    /// included in the measured times. Its workers are placed according to @placement.
+    explicit Solver(unsigned int num_threads = std::thread::hardware_concurrency(),
+                    parallel_bfs::PlacementPolicy placement = parallel_bfs::PlacementPolicy::Compact,
+                    BenchmarkConfig config = {})
+            : _pool{std::make_shared<parallel_bfs::ThreadPool>(num_threads, placement)}, _placement{placement}, _config{config} {
+        if (_config.perf_counters) _counters = std::make_unique<PerfCounters>(); // After the pool, to see its threads
+        parallel_bfs::detail::name_trace_thread("Solver");
+    }
+
     void add_algorithm(BfsCallable<State,TM> auto &&f, std::string&& name) {
         _bfs_functions.emplace_back(std::forward<decltype(f)>(f), std::move(name));
     }
 
+    void add_algorithm(PooledBfsCallable<State,TM> auto &&f, std::string&& name) {
+        auto algorithm = [f = std::forward<decltype(f)>(f), pool = _pool](const parallel_bfs::Problem<State, TM> &problem) {
+            return std::invoke(f, problem, *pool);
+        };
+        _bfs_functions.emplace_back(std::move(algorithm), std::move(name));
+    }
+
+    /**
+     * @brief Adds the AutoTuned algorithm (see parallel_bfs::AutoTuner), which chooses its strategy with @profile, and
+     * the TuningExploration algorithm, which runs the choices that @profile has measured the least (see
+     * parallel_bfs::AutoTuner::explore).
+     *
+     * Each problem is sampled once before its measured runs, and both algorithms use that sample. After each problem,
+     * the measured runs that are not outliers are added to @profile, keyed by the features of the problem: those of
+     * the algorithms that the tuner can choose (with their default parameters), those of TuningExploration (with the
+     * parameters that it ran), and apart from them, those of the AutoTuned algorithm (with the parameters that it
+     * chose).
+     */
+    void enable_tuning(std::shared_ptr<parallel_bfs::TuningProfile> profile) {
+        _profile = std::move(profile);
+        _tuner = std::make_shared<parallel_bfs::AutoTuner>(_profile, _pool->size(), _placement); // Creates its pools now
+        _sample = std::make_shared<std::optional<parallel_bfs::ProblemSample<State>>>();
+        // Outside of solve() (e.g. in the warm-up), there is no sample yet, so they take their own
+        add_algorithm([tuner = _tuner, sample = _sample](const parallel_bfs::Problem<State, TM> &problem, parallel_bfs::ThreadPool &pool) {
+            if (!sample->has_value()) return tuner->template search<State, TM>(problem, pool);
+            return tuner->template search<State, TM>(problem, pool, sample->value());
+        }, std::string{auto_tuned_name});
+        add_algorithm([tuner = _tuner, sample = _sample](const parallel_bfs::Problem<State, TM> &problem, parallel_bfs::ThreadPool &pool) {
+            if (!sample->has_value()) return tuner->template explore<State, TM>(problem, pool, parallel_bfs::sample_problem(problem));
+            return tuner->template explore<State, TM>(problem, pool, sample->value());
+        }, std::string{exploration_name});
+    }
+
+    /// Runs every algorithm warmup_rounds times (see BenchmarkConfig) without measuring them, so that the caches,
+    /// the allocator and the threads of the pool are warm for all of them, not only for the first one. Each round
+    /// takes as long as a measured repetition, so with no rounds (the default) a single random algorithm is run.
     void warm_cache(const parallel_bfs::Problem<State, TM> &problem) {
-        std::ranges::shuffle(_bfs_functions, _random_engine); // Shuffle to reduce the effect of caching
-        std::invoke(_bfs_functions[0].algorithm, problem); // Cache warming
+        if (_config.warmup_rounds == 0 && !_bfs_functions.empty()) {
+            std::ranges::shuffle(_bfs_functions, _random_engine); // Shuffle to reduce the effect of caching
+            std::invoke(_bfs_functions[0].algorithm, problem);
+        }
+        for (unsigned int round = 0; round < _config.warmup_rounds; ++round) {
+            std::ranges::shuffle(_bfs_functions, _random_engine);
+            for (const auto &[algo, algo_name] : _bfs_functions) std::invoke(algo, problem);
+        }
     }
 
+    /**
+     * @brief Measures every algorithm repetitions times (see BenchmarkConfig) on @problem.
+     *
+     * Each repetition runs all the algorithms in a new random order, so slow drifts of the machine (e.g. frequency
+     * scaling or other processes) and the state left by the previous algorithm affect all of them alike. Then, the
+     * outliers among the repetitions of each algorithm are marked, and excluded from the statistics.
+     */
     void solve(const parallel_bfs::Problem<State, TM> &problem, std::string problem_name) {
-        for (const auto & [algo, algo_name] : _bfs_functions) {
-            auto [solution, time] = invoke_and_time(algo, problem);
-            _results.emplace_back(problem_name, algo_name, time, solution);
+        const std::size_t first = _results.size();
+        std::string features_key; // Sampled once before the measured runs, so that all of them use the same features
+        if (_profile) {
+            *_sample = parallel_bfs::sample_problem(problem);
+            features_key = _sample->value().features.key();
+        }
+        for (unsigned int repetition = 0; repetition < _config.repetitions; ++repetition) {
+            std::ranges::shuffle(_bfs_functions, _random_engine);
+            for (const auto & [algo, algo_name] : _bfs_functions) {
+                parallel_bfs::reset_search_stats();
+                parallel_bfs::reset_search_trace();
+                if (_counters) _counters->start();
+                auto [solution, time] = invoke_and_time(algo, problem);
+                std::optional<PerfSample> counters;
+                if (_counters) counters = _counters->stop();
+                if (_trace) _trace->add(problem_name + " / " + algo_name + " #" + std::to_string(repetition), parallel_bfs::collect_search_trace());
+                std::optional<parallel_bfs::TuningChoice> tuning;
+                if (_tuner && (algo_name == auto_tuned_name || algo_name == exploration_name)) tuning = _tuner->last_choice();
+                _results.emplace_back(problem_name, algo_name, time, solution, repetition, false, counters, parallel_bfs::collect_search_stats(), tuning);
+            }
+        }
+
+        for (const auto &[algo, algo_name] : _bfs_functions) {
+            std::vector<Measurement<State> *> runs;
+            std::vector<double> times;
+            for (std::size_t i = first; i < _results.size(); ++i) {
+                if (_results[i].algorithm_name != algo_name) continue;
+                runs.push_back(&_results[i]);
+                times.push_back(_results[i].time.as_milliseconds());
+            }
+            const auto outliers = find_outliers(times, _config.outlier_threshold);
+            for (std::size_t i = 0; i < runs.size(); ++i) runs[i]->outlier = outliers[i];
+        }
+        if (_profile) {
+            update_profile(first, features_key);
+            _sample->reset();
         }
     }
 
@@ -89,28 +206,120 @@ public:
         for (const auto &[problem_name, measurements] : grouped) {
             stream << problem_name << "\n";
             for (const auto &m : measurements) {
-                stream << m.algorithm_name << ": " << m.time.as_milliseconds() << " ms, "
-                       << solution_path(m.solution.get()) << "\n";
+                stream << m.algorithm_name;
+                if (m.tuning) stream << " (" << parallel_bfs::to_string(*m.tuning) << ")";
+                stream << ": " << m.time.as_milliseconds() << " ms, " << solution_path(m.solution.get()) << "\n";
             }
             stream << "\n";
         }
         return stream.str();
     }
 
+    /// Statistics of the times of each algorithm. Like in SampleSummary, outliers are only left out of the statistics
+    /// that are not robust to them (see Statistic::robust).
     template<std::derived_from<Statistic>... Stats> requires (sizeof...(Stats) > 0)
     [[nodiscard]] std::string statistics_summary() const {
         std::stringstream stream;
         auto grouped = group_by_algorithm();
         for (const auto &[algo_name, measurements] : grouped) {
             stream << algo_name << '\n';
-            std::vector<double> times(measurements.size());
-            std::ranges::transform(measurements, times.begin(), [](const auto &m) { return m.time.as_milliseconds(); });
-            ((stream << "\t" << Stats{}.name() << ": " << Stats{}.compute(times) << " ms\n"), ...);
+            std::vector<double> times, kept;
+            for (const auto &m : measurements) {
+                times.push_back(m.time.as_milliseconds());
+                if (!m.outlier) kept.push_back(m.time.as_milliseconds());
+            }
+            ((stream << "\t" << Stats{}.name() << ": " << Stats{}.compute(Stats{}.robust() ? times : kept) << " ms\n"), ...);
+            if (_counters) stream << counters_summary(measurements);
+            if constexpr (parallel_bfs::search_stats_enabled) stream << search_summary(measurements);
         }
         return stream.str();
     }
 
+    /// Writes the timeline of every measured run to @path (see ChromeTraceWriter). Only has an effect if the library
+    /// was built with PARALLEL_BFS_ENABLE_TRACE.
+    void set_trace_output(const std::filesystem::path &path) {
+        if constexpr (parallel_bfs::search_trace_enabled) _trace = std::make_unique<ChromeTraceWriter>(path);
+    }
+
+    /// Metrics measured by the performance counters, or "none" if they are disabled (see BenchmarkConfig).
+    [[nodiscard]] std::string available_counters() const { return _counters ? _counters->available_metrics() : "none"; }
+
+    /// Every measured run, in the order in which they were run.
+    [[nodiscard]] const std::vector<Measurement<State>> &measurements() const { return _results; }
+
+    [[nodiscard]] const BenchmarkConfig &config() const { return _config; }
+
+    /// Names of the algorithms added by enable_tuning().
+    static constexpr std::string_view auto_tuned_name = "AutoTuned";
+    static constexpr std::string_view exploration_name = "TuningExploration";
+
 private:
+    /// Adds the measured runs since @first that are not outliers to the tuning profile, under @features_key. The runs of
+    /// the AutoTuned algorithm are recorded apart. Runs of algorithms that the tuner cannot choose, and of the tuning
+    /// algorithms when they made no choice, are left out.
+    void update_profile(std::size_t first, const std::string &features_key) {
+        for (std::size_t i = first; i < _results.size(); ++i) {
+            const auto &m = _results[i];
+            if (m.outlier) continue;
+            std::optional<parallel_bfs::TuningChoice> choice = m.tuning;
+            if (const auto strategy = parallel_bfs::parse_strategy(m.algorithm_name); !choice && strategy) {
+                const unsigned int threads = *strategy == parallel_bfs::Strategy::Sequential ? 1 : _pool->size();
+                choice = parallel_bfs::TuningChoice{*strategy, threads, parallel_bfs::default_granularity(*strategy)};
+            }
+            if (choice) _profile->record(features_key, *choice, m.time.as_milliseconds(), m.algorithm_name == auto_tuned_name);
+        }
+    }
+
+    /// Average and median of each metric of the performance counters, and the instructions per cycle, of the runs of
+    /// an algorithm that are not outliers. Metrics that could not be measured are left out.
+    [[nodiscard]] static std::string counters_summary(const std::vector<Measurement<State>> &measurements) {
+        std::stringstream stream;
+        std::array<std::vector<double>, num_perf_metrics> values;
+        for (const auto &m : measurements) {
+            if (m.outlier || !m.counters) continue;
+            for (std::size_t i = 0; i < num_perf_metrics; ++i)
+                if (m.counters->values[i]) values[i].push_back(*m.counters->values[i]);
+        }
+
+        for (std::size_t i = 0; i < num_perf_metrics; ++i) {
+            if (values[i].empty()) continue;
+            stream << "\t" << perf_metric_names[i] << ": " << Average{}.compute(values[i]) << " (average), "
+                   << Median{}.compute(values[i]) << " (median)\n";
+        }
+        const auto &cycles = values[static_cast<std::size_t>(PerfMetric::Cycles)];
+        const auto &instructions = values[static_cast<std::size_t>(PerfMetric::Instructions)];
+        if (!cycles.empty() && cycles.size() == instructions.size()) {
+            const double total_cycles = std::accumulate(cycles.begin(), cycles.end(), 0.0);
+            if (total_cycles > 0) stream << "\tInstructions per cycle: " << std::accumulate(instructions.begin(), instructions.end(), 0.0) / total_cycles << "\n";
+        }
+        return stream.str();
+    }
+
+    /// Average and median of each search statistic, and the fraction of the time that the threads were busy, of the
+    /// runs of an algorithm that are not outliers.
+    [[nodiscard]] static std::string search_summary(const std::vector<Measurement<State>> &measurements) {
+        std::stringstream stream;
+        std::array<std::vector<double>, num_search_metrics> values;
+        std::chrono::nanoseconds busy{0}, idle{0};
+        for (const auto &m : measurements) {
+            if (m.outlier || !m.search_stats) continue;
+            const auto run_values = search_metric_values(*m.search_stats);
+            for (std::size_t i = 0; i < num_search_metrics; ++i)
+                if (run_values[i]) values[i].push_back(*run_values[i]);
+            busy += m.search_stats->busy();
+            idle += m.search_stats->idle();
+        }
+
+        for (std::size_t i = 0; i < num_search_metrics; ++i) {
+            if (values[i].empty()) continue;
+            stream << "\t" << search_metric_names[i] << ": " << Average{}.compute(values[i]) << " (average), "
+                   << Median{}.compute(values[i]) << " (median)\n";
+        }
+        if ((busy + idle).count() > 0)
+            stream << "\tUtilization: " << 100.0 * static_cast<double>(busy.count()) / static_cast<double>((busy + idle).count()) << " %\n";
+        return stream.str();
+    }
+
     [[nodiscard]] std::unordered_map<std::string, std::vector<Measurement<State>>> group_by_problem() const {
         std::unordered_map<std::string, std::vector<Measurement<State>>> grouped;
         for (const auto &result : _results) grouped[result.problem_name].push_back(result);
@@ -123,6 +332,14 @@ private:
         return grouped;
     }
 
+    std::shared_ptr<parallel_bfs::ThreadPool> _pool;
+    parallel_bfs::PlacementPolicy _placement;
+    BenchmarkConfig _config;
+    std::unique_ptr<PerfCounters> _counters{nullptr};
+    std::unique_ptr<ChromeTraceWriter> _trace{nullptr};
+    std::shared_ptr<parallel_bfs::TuningProfile> _profile{nullptr};
+    std::shared_ptr<parallel_bfs::AutoTuner> _tuner{nullptr};
+    std::shared_ptr<std::optional<parallel_bfs::ProblemSample<State>>> _sample{nullptr}; // Of the problem being solved
     std::vector<BfsAlgorithm<State, TM>> _bfs_functions;
     std::vector<Measurement<State>> _results;
     std::default_random_engine _random_engine{std::random_device{}()};
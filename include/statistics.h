@@ -11,6 +11,8 @@
 #include <numeric>
 #include <algorithm>
 #include <cmath>
+#include <numbers>
+#include <stdexcept>
 
 
 class Statistic {
@@ -18,6 +20,8 @@ public:
     virtual ~Statistic() = default;
     [[nodiscard]] virtual double compute(const std::vector<double>& data) const = 0;
     [[nodiscard]] virtual std::string name() const = 0;
+    /// Whether the statistic is robust to outliers, so that it can be computed over all the values, outliers included.
+    [[nodiscard]] virtual bool robust() const { return false; }
 
     std::execution::unsequenced_policy policy = std::execution::unseq;
 };
@@ -53,6 +57,8 @@ public:
     }
 
     [[nodiscard]] inline std::string name() const override { return "Median"; }
+
+    [[nodiscard]] bool robust() const override { return true; }
 };
 
 
@@ -75,4 +81,111 @@ public:
 };
 
 
+class Minimum : public Statistic {
+public:
+    [[nodiscard]] double compute(const std::vector<double>& data) const override {
+        if (data.empty()) throw std::invalid_argument("Data cannot be empty");
+        return *std::min_element(policy, data.begin(), data.end());
+    }
+
+    [[nodiscard]] inline std::string name() const override { return "Minimum"; }
+
+    [[nodiscard]] bool robust() const override { return true; }
+};
+
+
+/// Value below which @fraction of @data lies, interpolating linearly between the closest ranks.
+inline double percentile(std::vector<double> data, double fraction) {
+    if (data.empty()) throw std::invalid_argument("Data cannot be empty");
+    std::sort(data.begin(), data.end());
+    const double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(data.size() - 1);
+    const auto lower = static_cast<std::size_t>(rank);
+    if (lower + 1 == data.size()) return data.back();
+    return data[lower] + (rank - static_cast<double>(lower)) * (data[lower + 1] - data[lower]);
+}
+
+
+template<unsigned int P> requires (P <= 100)
+class Percentile : public Statistic {
+public:
+    [[nodiscard]] double compute(const std::vector<double>& data) const override { return percentile(data, P / 100.0); }
+
+    [[nodiscard]] inline std::string name() const override { return "P" + std::to_string(P); }
+
+    [[nodiscard]] bool robust() const override { return true; }
+};
+
+
+/// Quantile @p of the standard normal distribution (Acklam's rational approximation, relative error below 1.2e-9).
+inline double normal_quantile(double p) {
+    if (p <= 0.0 || p >= 1.0) throw std::invalid_argument("The probability must be in (0, 1)");
+    constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01};
+    constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00};
+    constexpr double p_low = 0.02425;
+
+    if (p < p_low || p > 1 - p_low) {
+        const double q = std::sqrt(-2 * std::log(p < p_low ? p : 1 - p));
+        const double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        return p < p_low ? x : -x;
+    }
+    const double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+
+/// Quantile @p of Student's t distribution with @dof degrees of freedom. Exact for 1 and 2 degrees of freedom, and a
+/// Cornish-Fisher expansion around the normal quantile otherwise (error below 1% for 3 degrees, and falling).
+inline double t_quantile(double p, unsigned int dof) {
+    if (dof == 0) throw std::invalid_argument("At least one degree of freedom is needed");
+    if (dof == 1) return std::tan(std::numbers::pi * (p - 0.5));
+    if (dof == 2) return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+
+    const double z = normal_quantile(p), n = dof, z2 = z * z;
+    return z + z * (z2 + 1) / (4 * n)
+             + z * ((5 * z2 + 16) * z2 + 3) / (96 * n * n)
+             + z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * n * n * n);
+}
+
+
+/// Half-width of the two-sided confidence interval of the mean at the @Level % confidence level (Student's t).
+/// It is 0 with fewer than two values, since the variance cannot be estimated.
+template<unsigned int Level = 95> requires (Level > 0 && Level < 100)
+class ConfidenceInterval : public Statistic {
+public:
+    [[nodiscard]] double compute(const std::vector<double>& data) const override {
+        if (data.empty()) throw std::invalid_argument("Data cannot be empty");
+        if (data.size() < 2) return 0.0;
+        const double n = static_cast<double>(data.size());
+        const double sample_sd = StandardDeviation{}.compute(data) * std::sqrt(n / (n - 1)); // Bessel's correction
+        return t_quantile(0.5 + Level / 200.0, static_cast<unsigned int>(data.size() - 1)) * sample_sd / std::sqrt(n);
+    }
+
+    [[nodiscard]] inline std::string name() const override { return std::to_string(Level) + "% CI half-width"; }
+};
+
+
+/**
+ * @brief Marks the values of @data that are outliers according to their modified z-score (Iglewicz and Hoaglin).
+ *
+ * The score of a value is its distance to the median in units of the median absolute deviation (MAD), which, unlike
+ * the standard deviation, is not inflated by the outliers themselves. Values whose score is above @threshold are
+ * outliers. Nothing is marked when more than half of the values are equal (the MAD is 0).
+ */
+inline std::vector<bool> find_outliers(const std::vector<double>& data, double threshold = 3.5) {
+    std::vector<bool> outliers(data.size(), false);
+    if (data.size() < 3) return outliers;
+
+    const double median = Median{}.compute(data);
+    std::vector<double> deviations(data.size());
+    std::transform(data.begin(), data.end(), deviations.begin(), [median](double x) { return std::abs(x - median); });
+    const double mad = Median{}.compute(deviations);
+    if (mad == 0.0) return outliers;
+
+    for (std::size_t i = 0; i < data.size(); ++i) outliers[i] = 0.6745 * deviations[i] / mad > threshold;
+    return outliers;
+}
+
+
 #endif //PARALLEL_BFS_PROJECT_STATISTICS_H
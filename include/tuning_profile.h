@@ -0,0 +1,83 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_TUNING_PROFILE_H
+#define PARALLEL_BFS_PROJECT_TUNING_PROFILE_H
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+#include <parallel_bfs/search/auto_tuner.h>
+
+
+/**
+ * @brief Reads a tuning profile written by write_tuning_profile.
+ *
+ * The file maps the key of each kind of problem (see parallel_bfs::ProblemFeatures::key) to the choices measured on
+ * it. Those of the AutoTuned algorithm are marked with "auto_tuned: true". Choices of unknown strategies (e.g. written
+ * by another version of the program) are skipped.
+ *
+ * @param path The profile file. If it does not exist, the profile is empty.
+ * @return The profile.
+ */
+[[nodiscard]] parallel_bfs::TuningProfile read_tuning_profile(const std::filesystem::path &path) noexcept(false) {
+    parallel_bfs::TuningProfile profile;
+    if (!std::filesystem::exists(path)) return profile;
+
+    const YAML::Node root = YAML::LoadFile(path.string());
+    if (!root.IsMap()) throw std::runtime_error{"Invalid tuning profile: " + path.string()};
+    for (const auto &problem: root) {
+        const auto key = problem.first.as<std::string>();
+        for (const auto &choice: problem.second) {
+            const auto strategy = parallel_bfs::parse_strategy(choice["strategy"].as<std::string>());
+            if (!strategy.has_value()) continue;
+            const bool auto_tuned = choice["auto_tuned"] && choice["auto_tuned"].as<bool>();
+            profile.set(key, {strategy.value(), choice["threads"].as<unsigned int>(), choice["granularity"].as<unsigned int>()},
+                        {choice["runs"].as<unsigned int>(), choice["average_ms"].as<double>()}, auto_tuned);
+        }
+    }
+    return profile;
+}
+
+
+/**
+ * @brief Writes a tuning profile in YAML format, with one entry per measured choice of each kind of problem (see
+ * read_tuning_profile).
+ *
+ * @param path The profile file. It is overwritten.
+ * @param profile The profile.
+ */
+void write_tuning_profile(const std::filesystem::path &path, const parallel_bfs::TuningProfile &profile) {
+    YAML::Emitter emitter;
+    emitter << YAML::Comment("Running times of each strategy on each kind of problem (see --tune)") << YAML::BeginMap;
+    const auto write_choices = [&emitter](const auto &problems, const std::string &key, bool auto_tuned) {
+        const auto problem = problems.find(key);
+        if (problem == problems.end()) return;
+        for (const auto &[choice, entry]: problem->second) {
+            emitter << YAML::Flow << YAML::BeginMap
+                    << YAML::Key << "strategy" << YAML::Value << std::string{parallel_bfs::strategy_name(choice.strategy)}
+                    << YAML::Key << "threads" << YAML::Value << choice.threads
+                    << YAML::Key << "granularity" << YAML::Value << choice.granularity
+                    << YAML::Key << "runs" << YAML::Value << entry.runs
+                    << YAML::Key << "average_ms" << YAML::Value << entry.average_ms;
+            if (auto_tuned) emitter << YAML::Key << "auto_tuned" << YAML::Value << true;
+            emitter << YAML::EndMap;
+        }
+    };
+    for (const auto &key: profile.keys()) {
+        emitter << YAML::Key << key << YAML::Value << YAML::BeginSeq;
+        write_choices(profile.problems(), key, false);
+        write_choices(profile.auto_tuned(), key, true);
+        emitter << YAML::EndSeq;
+    }
+    emitter << YAML::EndMap;
+
+    std::ofstream out{path};
+    out << emitter.c_str() << '\n';
+}
+
+
+#endif //PARALLEL_BFS_PROJECT_TUNING_PROFILE_H
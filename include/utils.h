@@ -16,15 +16,10 @@ struct ExecutionTime {
     explicit ExecutionTime() = default;
     explicit ExecutionTime(TimePoint start, TimePoint end) : start{start}, end{end} {}
 
-    [[nodiscard]] double as_milliseconds() const {
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        return std::round(duration / 10) / 100;
-    }
+    /// Full resolution of the clock: sub-millisecond searches must not be rounded away.
+    [[nodiscard]] double as_milliseconds() const { return std::chrono::duration<double, std::milli>(end - start).count(); }
 
-    [[nodiscard]] double as_seconds() const {
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        return std::round(duration / 10) / 100;
-    }
+    [[nodiscard]] double as_seconds() const { return std::chrono::duration<double>(end - start).count(); }
 
     static TimePoint now() { return std::chrono::high_resolution_clock::now(); }
 
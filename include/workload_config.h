@@ -0,0 +1,64 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_WORKLOAD_CONFIG_H
+#define PARALLEL_BFS_PROJECT_WORKLOAD_CONFIG_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <chrono>
+#include <stdexcept>
+#include <parallel_bfs/search.h>
+
+
+/// Longest busy wait per goal test accepted in the command line (-d, and -w spin or variable).
+inline constexpr std::chrono::microseconds max_workload_delay{500};
+
+
+/**
+ * @brief Parses a goal-test workload specification given in the command line.
+ *
+ * Supported formats (durations in microseconds):
+ *  - spin:TIME                          Busy wait of TIME (same as --workload-delay=TIME).
+ *  - compute:ITERATIONS                 CPU-bound kernel.
+ *  - memory:MIB:ACCESSES                ACCESSES dependent loads from a buffer of MIB mebibytes.
+ *  - variable:TIME[:uniform|exponential] Busy wait drawn per state from a distribution with mean TIME.
+ *
+ * @throw std::invalid_argument If the specification is not valid, or its TIME is above max_workload_delay.
+ */
+[[nodiscard]] std::shared_ptr<const parallel_bfs::WorkloadModel> parse_workload(const std::string &spec) noexcept(false) {
+    std::vector<std::string> fields;
+    std::stringstream stream{spec};
+    for (std::string field; std::getline(stream, field, ':');) fields.push_back(field);
+    if (fields.size() < 2) throw std::invalid_argument("Invalid workload specification: " + spec);
+
+    const std::string &kind = fields[0];
+    const auto number = [&fields](std::size_t i) { return std::stoull(fields.at(i)); };
+    const auto delay = [&number](std::size_t i) {
+        const std::chrono::microseconds time{number(i)};
+        if (time > max_workload_delay)
+            throw std::invalid_argument("Workload delay too high (max " + std::to_string(max_workload_delay.count()) + " microseconds)");
+        return time;
+    };
+
+    if (kind == "spin" && fields.size() == 2)
+        return std::make_shared<const parallel_bfs::SpinWorkload>(delay(1));
+    if (kind == "compute" && fields.size() == 2)
+        return std::make_shared<const parallel_bfs::ComputeWorkload>(number(1));
+    if (kind == "memory" && fields.size() == 3)
+        return std::make_shared<const parallel_bfs::MemoryWorkload>(number(1) << 20, number(2));
+    if (kind == "variable" && (fields.size() == 2 || fields.size() == 3)) {
+        using Distribution = parallel_bfs::VariableWorkload::Distribution;
+        Distribution distribution = Distribution::Exponential;
+        if (fields.size() == 3 && fields[2] == "uniform") distribution = Distribution::Uniform;
+        else if (fields.size() == 3 && fields[2] != "exponential") throw std::invalid_argument("Unknown distribution: " + fields[2]);
+        return std::make_shared<const parallel_bfs::VariableWorkload>(delay(1), distribution);
+    }
+
+    throw std::invalid_argument("Invalid workload specification: " + spec);
+}
+
+#endif //PARALLEL_BFS_PROJECT_WORKLOAD_CONFIG_H
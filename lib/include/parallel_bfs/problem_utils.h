@@ -5,6 +5,7 @@
 #ifndef PARALLEL_BFS_PROBLEM_UTILS_H
 #define PARALLEL_BFS_PROBLEM_UTILS_H
 
+#include "problem_utils/binary_format.h"
 #include "problem_utils/problem_factory.h"
 #include "problem_utils/problem_reader.h"
 #include "problem_utils/problem_writer.h"
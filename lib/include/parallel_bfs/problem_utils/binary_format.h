@@ -0,0 +1,224 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_BINARY_FORMAT_H
+#define PARALLEL_BFS_BINARY_FORMAT_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include "../problems/problems_common.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PARALLEL_BFS_HAS_MMAP 1
+#endif
+
+
+namespace parallel_bfs {
+    /// Identifiers of the state and transition model types stored in a binary problem file. Never reuse a value.
+    enum class BinaryTypeTag : std::uint16_t {
+        Integer = 1,
+        TreeState = 2,
+        CsrGraph = 16,
+        CsrTree = 17,
+    };
+
+
+    /**
+     * @brief Fixed-size header at the beginning of a binary problem file (extension ".pbfs").
+     *
+     * The file stores a CSR transition model and the states of the problem as flat arrays of values. Every section
+     * starts at a multiple of binary_section_alignment, so the arrays of a memory-mapped file can be used in place.
+     * Numbers are written in the byte order of the machine that wrote the file, which is recorded in @byte_order.
+     *
+     * Sections (element type, number of elements):
+     *  - offsets (uint64, num_nodes + 1) and edges (value, num_edges) of the transition model.
+     *  - initial (value, initial_length): the encoded initial state.
+     *  - goal offsets (uint64, num_goals + 1) and goal values (value, goal_values): goal i is encoded in the range
+     *    [goal_offsets[i], goal_offsets[i+1]) of the goal values.
+     */
+    struct BinaryHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint16_t state_tag;
+        std::uint16_t model_tag;
+        std::uint16_t value_size; // Size in bytes of the values of the edges and states
+        std::uint16_t reserved;
+        std::uint64_t num_nodes;
+        std::uint64_t num_edges;
+        std::uint64_t initial_length;
+        std::uint64_t num_goals;
+        std::uint64_t goal_values;
+        std::uint64_t offsets_pos; // Positions are byte offsets from the beginning of the file
+        std::uint64_t edges_pos;
+        std::uint64_t initial_pos;
+        std::uint64_t goal_offsets_pos;
+        std::uint64_t goal_values_pos;
+    };
+
+    static_assert(std::is_trivially_copyable_v<BinaryHeader> && sizeof(BinaryHeader) == 104);
+
+    inline constexpr char binary_magic[8] = {'P', 'B', 'F', 'S', 'P', 'R', 'B', '\0'};
+    inline constexpr std::uint32_t binary_version = 1;
+    inline constexpr std::uint32_t binary_byte_order = 0x01020304;
+    inline constexpr std::size_t binary_section_alignment = 64;
+
+
+    /**
+     * @brief Conversion of a type to and from the binary problem format. Specialized next to each supported type.
+     *
+     * State codecs define value_type, tag, encode(state, values) (appends the encoding to @values) and
+     * decode(span of values). Transition model codecs define value_type, tag, offsets(tm), edges(tm) and
+     * make(owner, offsets, edges), which builds a model that views the arrays owned by @owner.
+     */
+    template<typename T>
+    struct BinaryCodec;
+
+
+    template<typename S>
+    concept BinaryConvertibleState = requires(const S &s, std::vector<typename BinaryCodec<S>::value_type> &out,
+                                              std::span<const typename BinaryCodec<S>::value_type> values) {
+        { BinaryCodec<S>::tag } -> std::convertible_to<BinaryTypeTag>;
+        BinaryCodec<S>::encode(s, out);
+        { BinaryCodec<S>::decode(values) } -> std::same_as<S>;
+    };
+
+
+    template<typename TM>
+    concept BinaryConvertibleModel = requires(const TM &tm, std::shared_ptr<const void> owner, std::span<const std::size_t> offsets,
+                                              std::span<const typename BinaryCodec<TM>::value_type> edges) {
+        { BinaryCodec<TM>::tag } -> std::convertible_to<BinaryTypeTag>;
+        { BinaryCodec<TM>::offsets(tm) } -> std::same_as<std::span<const std::size_t>>;
+        { BinaryCodec<TM>::edges(tm) } -> std::same_as<std::span<const typename BinaryCodec<TM>::value_type>>;
+        { BinaryCodec<TM>::make(owner, offsets, edges) } -> std::same_as<TM>;
+    };
+
+
+    /// Unsigned integer states (e.g. the nodes of a graph) are encoded as a single value.
+    template<detail::UnsignedInteger T>
+    struct BinaryCodec<T> {
+        using value_type = T;
+        static constexpr BinaryTypeTag tag = BinaryTypeTag::Integer;
+
+        static void encode(const T &state, std::vector<T> &values) { values.push_back(state); }
+
+        [[nodiscard]] static T decode(std::span<const T> values) {
+            if (values.size() != 1) throw std::runtime_error("Invalid encoding of an integer state.");
+            return values.front();
+        }
+    };
+
+
+    /**
+     * @brief Read-only view of the contents of a file, memory-mapped when the platform supports it.
+     *
+     * Pages are loaded lazily by the operating system, so opening a file is O(1) and only the parts that are used
+     * are ever read. Without mmap support, the whole file is read into memory instead.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path &path) {
+#ifdef PARALLEL_BFS_HAS_MMAP
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::system_error(errno, std::generic_category(), "Could not open " + path.string());
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Could not stat " + path.string());
+            }
+
+            _size = static_cast<std::size_t>(info.st_size);
+            if (_size > 0) {
+                void *address = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                const int error = errno;
+                ::close(fd); // The mapping keeps its own reference to the file
+                if (address == MAP_FAILED) throw std::system_error(error, std::generic_category(), "Could not map " + path.string());
+                ::posix_madvise(address, _size, POSIX_MADV_WILLNEED);
+                _data = static_cast<const std::byte *>(address);
+            } else {
+                ::close(fd);
+            }
+#else
+            std::ifstream input{path, std::ios::binary};
+            if (!input) throw std::runtime_error("Could not open " + path.string());
+            _buffer.resize(std::filesystem::file_size(path));
+            input.read(reinterpret_cast<char *>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+            if (!input) throw std::runtime_error("Could not read " + path.string());
+            _data = _buffer.data();
+            _size = _buffer.size();
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+#ifdef PARALLEL_BFS_HAS_MMAP
+            if (_data != nullptr) ::munmap(const_cast<std::byte *>(_data), _size);
+#endif
+        }
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return {_data, _size}; }
+
+    private:
+        const std::byte *_data{nullptr};
+        std::size_t _size{0};
+#ifndef PARALLEL_BFS_HAS_MMAP
+        std::vector<std::byte> _buffer{};
+#endif
+    };
+}
+
+
+
+namespace parallel_bfs::detail {
+    [[nodiscard]] constexpr std::uint64_t align_section(std::uint64_t position) noexcept {
+        return (position + binary_section_alignment - 1) / binary_section_alignment * binary_section_alignment;
+    }
+
+
+    /// Copies the header out of @bytes and checks that it can be read by this version of the library.
+    [[nodiscard]] inline BinaryHeader read_binary_header(std::span<const std::byte> bytes) {
+        BinaryHeader header{};
+        if (bytes.size() < sizeof(header)) throw std::runtime_error("Binary problem file too small.");
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0)
+            throw std::runtime_error("Not a binary problem file.");
+        if (header.byte_order != binary_byte_order)
+            throw std::runtime_error("Binary problem file written on a machine with a different byte order.");
+        if (header.version != binary_version)
+            throw std::runtime_error("Unsupported binary problem file version: " + std::to_string(header.version));
+        return header;
+    }
+
+
+    /// Views @count elements of type V stored at byte @position of @bytes, checking that they are within bounds.
+    template<typename V>
+    [[nodiscard]] std::span<const V> binary_section(std::span<const std::byte> bytes, std::uint64_t position, std::uint64_t count) {
+        if (position % alignof(V) != 0 || position > bytes.size() || count > (bytes.size() - position) / sizeof(V))
+            throw std::runtime_error("Corrupted binary problem file.");
+        return {reinterpret_cast<const V *>(bytes.data() + position), static_cast<std::size_t>(count)};
+    }
+}
+
+#endif //PARALLEL_BFS_BINARY_FORMAT_H
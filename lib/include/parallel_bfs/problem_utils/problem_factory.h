@@ -9,7 +9,10 @@
 #include <random>
 #include <optional>
 #include <algorithm>
+#include <limits>
+#include <cstdint>
 #include "../search/problem.h"
+#include "../search/workload.h"
 
 
 namespace parallel_bfs::detail {
@@ -18,6 +21,34 @@ namespace parallel_bfs::detail {
         typename T::result_type;  // This requires T to have a type named result_type
         { dist(engine) } -> std::same_as<U>;
     };
+
+
+    /// Small PRNG (splitmix64) that is cheap enough to be seeded once per generated element, so that elements can be
+    /// generated independently (e.g. by different threads) and still be reproducible.
+    class SplitMix64 {
+    public:
+        using result_type = std::uint64_t;
+
+        explicit SplitMix64(std::uint64_t seed) noexcept : _state{seed} {}
+
+        static constexpr result_type min() noexcept { return std::numeric_limits<result_type>::min(); }
+
+        static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() noexcept { return mix64(_state += 0x9e3779b97f4a7c15ULL); }
+
+        /// Integer in [0, @bound), from the upper 32 bits of the next value with a multiply-shift (Lemire). Unlike
+        /// std::uniform_int_distribution, the result does not depend on the standard library implementation.
+        std::uint32_t bounded(std::uint32_t bound) noexcept {
+            return static_cast<std::uint32_t>(((*this)() >> 32) * bound >> 32);
+        }
+
+        /// True with probability @p. Like bounded(), the result does not depend on the standard library.
+        bool bernoulli(double p) noexcept { return static_cast<double>((*this)() >> 11) * 0x1.0p-53 < p; }
+
+    private:
+        std::uint64_t _state;
+    };
 }
 
 
@@ -43,7 +74,7 @@ namespace parallel_bfs {
     template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
     class RandomFactory : public ProblemFactory<State, TM> {
     public:
-        [[nodiscard]] Problem<State, TM> make_problem(std::optional<unsigned int> seed = std::nullopt) {
+        [[nodiscard]] Problem<State, TM> make_problem(std::optional<std::uint64_t> seed = std::nullopt) {
             set_random_engine(seed);
             return ProblemFactory<State, TM>::make_problem();
         }
@@ -73,14 +104,18 @@ namespace parallel_bfs {
         }
 
     private:
-        void set_random_engine(std::optional<unsigned int> seed) {
+        void set_random_engine(std::optional<std::uint64_t> seed) {
             // Only reseed if the seed is specified or if the PRNG was manually seeded before
             if (seed.has_value() or _manually_seeded) _prng_engine = get_random_engine(seed);
             _manually_seeded = seed.has_value();
         }
 
-        static std::default_random_engine get_random_engine(std::optional<unsigned int> seed = std::nullopt) {
-            if (seed.has_value()) return std::default_random_engine{seed.value()};
+        /// All the bits of @seed are used: its two halves are mixed with std::seed_seq.
+        static std::default_random_engine get_random_engine(std::optional<std::uint64_t> seed = std::nullopt) {
+            if (seed.has_value()) {
+                std::seed_seq seed_seq{static_cast<std::uint32_t>(seed.value()), static_cast<std::uint32_t>(seed.value() >> 32)};
+                return std::default_random_engine{seed_seq};
+            }
             std::random_device r;
             std::seed_seq seed2{r(), r(), r(), r(), r(), r(), r(), r()};
             return std::default_random_engine{seed2};
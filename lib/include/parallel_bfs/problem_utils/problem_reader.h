@@ -8,7 +8,11 @@
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <memory>
+#include <limits>
+#include <unordered_set>
 #include <yaml-cpp/yaml.h>
+#include "binary_format.h"
 #include "problem_writer.h"
 
 namespace parallel_bfs {
@@ -27,6 +31,54 @@ namespace parallel_bfs {
 
         std::string file_extension{".yaml"};
     };
+
+
+
+    /**
+     * @brief Loads problems written by BinaryWriter.
+     *
+     * The file is memory-mapped and the transition model views its arrays in place, so loading does not parse nor
+     * copy the model: its pages are read from disk the first time that the search touches them. Only the (few)
+     * initial and goal states are decoded.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    requires BinaryConvertibleState<State> && BinaryConvertibleModel<TM> &&
+             std::same_as<typename BinaryCodec<State>::value_type, typename BinaryCodec<TM>::value_type>
+    class BinaryReader {
+    public:
+        [[nodiscard]] Problem<State, TM> read(const std::filesystem::path &input_path) const {
+            using Value = typename BinaryCodec<TM>::value_type;
+            static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "The binary format stores offsets as 64-bit integers.");
+
+            auto file = std::make_shared<const MappedFile>(input_path);
+            const std::span<const std::byte> bytes = file->bytes();
+            const BinaryHeader header = detail::read_binary_header(bytes);
+            if (header.state_tag != static_cast<std::uint16_t>(BinaryCodec<State>::tag) ||
+                header.model_tag != static_cast<std::uint16_t>(BinaryCodec<TM>::tag) || header.value_size != sizeof(Value))
+                throw std::runtime_error("The problem in " + input_path.string() + " has different state or transition model types.");
+            if (header.num_nodes == std::numeric_limits<std::uint64_t>::max() || header.num_goals == std::numeric_limits<std::uint64_t>::max())
+                throw std::runtime_error("Corrupted binary problem file.");
+
+            const auto offsets = detail::binary_section<std::size_t>(bytes, header.offsets_pos, header.num_nodes + 1);
+            const auto edges = detail::binary_section<Value>(bytes, header.edges_pos, header.num_edges);
+            const auto initial = detail::binary_section<Value>(bytes, header.initial_pos, header.initial_length);
+            const auto goal_offsets = detail::binary_section<std::uint64_t>(bytes, header.goal_offsets_pos, header.num_goals + 1);
+            const auto goal_values = detail::binary_section<Value>(bytes, header.goal_values_pos, header.goal_values);
+
+            std::unordered_set<State> goal_states;
+            goal_states.reserve(header.num_goals);
+            for (std::size_t i = 0; i < header.num_goals; ++i) {
+                if (goal_offsets[i] > goal_offsets[i + 1] || goal_offsets[i + 1] > goal_values.size())
+                    throw std::runtime_error("Corrupted binary problem file.");
+                goal_states.insert(BinaryCodec<State>::decode(goal_values.subspan(goal_offsets[i], goal_offsets[i + 1] - goal_offsets[i])));
+            }
+
+            TM transition_model = BinaryCodec<TM>::make(std::move(file), offsets, edges);
+            return Problem<State, TM>{BinaryCodec<State>::decode(initial), std::move(goal_states), std::move(transition_model)};
+        }
+
+        std::string file_extension{".pbfs"};
+    };
 }
 
 #endif //PARALLEL_BFS_PROBLEM_READER_H
@@ -9,7 +9,10 @@
 #include <filesystem>
 #include <string>
 #include <unordered_set>
+#include <vector>
+#include <fstream>
 #include <yaml-cpp/yaml.h>
+#include "binary_format.h"
 #include "type_name.h"
 
 
@@ -22,15 +25,20 @@ namespace parallel_bfs {
     };
 
 
+    /// Writes problems as YAML documents. Transition models are streamed to the file while they are being emitted.
     class YAMLWriter {
     public:
         template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
         requires ConvertibleToYAML<State> && ConvertibleToYAML<TM>
         void write(const Problem<State, TM> &problem, const std::filesystem::path &output_path) const {
-            std::ofstream output_file{output_path};
+            // The emitter writes straight to the file through a large buffer, so the document is never held in memory
+            std::vector<char> buffer(buffer_size);
+            std::ofstream output_file;
+            output_file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            output_file.open(output_path);
             if (!output_file) throw std::runtime_error("Could not create file to write problem.");
 
-            YAML::Emitter emitter;
+            YAML::Emitter emitter{output_file};
             emitter << YAML::BeginMap;
             emitter << YAML::Key << "state type" << YAML::Value << std::string{type_name<State>()};
             emitter << YAML::Key << "transition model type" << YAML::Value << std::string{type_name<TM>()};
@@ -38,18 +46,91 @@ namespace parallel_bfs {
             emitter << YAML::Key << "goal states" << YAML::Value << problem.goal_states();
             emitter << YAML::Key << "transition model" << YAML::Value << problem.transition_model();
             emitter << YAML::EndMap;
+            output_file << '\n';
 
-            output_file << emitter.c_str() << '\n';
+            if (!emitter.good()) throw std::runtime_error("Could not emit problem: " + emitter.GetLastError());
+            output_file.close();
+            if (!output_file) throw std::runtime_error("Could not write problem to " + output_path.string());
         }
 
         std::string file_extension{".yaml"};
+
+    private:
+        static constexpr std::size_t buffer_size = 1 << 20;
+    };
+
+
+
+    /// Writes problems in the binary format described in BinaryHeader, which BinaryReader can load without parsing.
+    class BinaryWriter {
+    public:
+        template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+        requires BinaryConvertibleState<State> && BinaryConvertibleModel<TM> &&
+                 std::same_as<typename BinaryCodec<State>::value_type, typename BinaryCodec<TM>::value_type>
+        void write(const Problem<State, TM> &problem, const std::filesystem::path &output_path) const {
+            using Value = typename BinaryCodec<TM>::value_type;
+            static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "The binary format stores offsets as 64-bit integers.");
+
+            std::vector<Value> initial;
+            BinaryCodec<State>::encode(problem.initial(), initial);
+
+            const auto &goal_states = problem.goal_states();
+            std::vector<std::uint64_t> goal_offsets{0};
+            std::vector<Value> goal_values;
+            goal_offsets.reserve(goal_states.size() + 1);
+            for (const State &goal: goal_states) {
+                BinaryCodec<State>::encode(goal, goal_values);
+                goal_offsets.push_back(goal_values.size());
+            }
+
+            const std::span<const std::size_t> offsets = BinaryCodec<TM>::offsets(problem.transition_model());
+            const std::span<const Value> edges = BinaryCodec<TM>::edges(problem.transition_model());
+
+            BinaryHeader header{};
+            std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+            header.version = binary_version;
+            header.byte_order = binary_byte_order;
+            header.state_tag = static_cast<std::uint16_t>(BinaryCodec<State>::tag);
+            header.model_tag = static_cast<std::uint16_t>(BinaryCodec<TM>::tag);
+            header.value_size = sizeof(Value);
+            header.num_nodes = offsets.size() - 1;
+            header.num_edges = edges.size();
+            header.initial_length = initial.size();
+            header.num_goals = goal_states.size();
+            header.goal_values = goal_values.size();
+            header.offsets_pos = detail::align_section(sizeof(BinaryHeader));
+            header.edges_pos = detail::align_section(header.offsets_pos + offsets.size_bytes());
+            header.initial_pos = detail::align_section(header.edges_pos + edges.size_bytes());
+            header.goal_offsets_pos = detail::align_section(header.initial_pos + initial.size() * sizeof(Value));
+            header.goal_values_pos = detail::align_section(header.goal_offsets_pos + goal_offsets.size() * sizeof(std::uint64_t));
+
+            std::ofstream output_file{output_path, std::ios::binary};
+            if (!output_file) throw std::runtime_error("Could not create file to write problem.");
+
+            std::uint64_t position = 0;
+            const auto write_section = [&output_file, &position](std::uint64_t section_pos, const void *data, std::size_t size) {
+                static constexpr char padding[binary_section_alignment] = {};
+                output_file.write(padding, static_cast<std::streamsize>(section_pos - position));
+                output_file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+                position = section_pos + size;
+            };
+            write_section(0, &header, sizeof(header));
+            write_section(header.offsets_pos, offsets.data(), offsets.size_bytes());
+            write_section(header.edges_pos, edges.data(), edges.size_bytes());
+            write_section(header.initial_pos, initial.data(), initial.size() * sizeof(Value));
+            write_section(header.goal_offsets_pos, goal_offsets.data(), goal_offsets.size() * sizeof(std::uint64_t));
+            write_section(header.goal_values_pos, goal_values.data(), goal_values.size() * sizeof(Value));
+            if (!output_file) throw std::runtime_error("Could not write problem to " + output_path.string());
+        }
+
+        std::string file_extension{".pbfs"};
     };
 }
 
 
 
 namespace YAML {
-    // Template specialization for std::unordered_set<T>. Needed for problem.goal_states().
+    // Template specialization for std::vector<T> and std::unordered_set<T>. Needed for problem.goal_states().
     template<parallel_bfs::ConvertibleToYAML T>
     struct convert<std::unordered_set<T>> {
         static Node encode(const std::unordered_set<T> &rhs) {
@@ -67,7 +148,7 @@ namespace YAML {
 
 
     template<parallel_bfs::ConvertibleToYAML T>
-    Emitter& operator << (Emitter& out, const std::unordered_set<T> s) {
+    Emitter& operator << (Emitter& out, const std::unordered_set<T> &s) {
         out << YAML::BeginSeq;
         std::for_each(s.cbegin(), s.cend(), [&out](const T &v) { out << v; });
         out << YAML::EndSeq;
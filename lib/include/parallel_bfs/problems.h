@@ -7,8 +7,13 @@
 
 #include "problems/basic_graph/basic_graph.h"
 #include "problems/basic_graph/basic_graph_generator.h"
+#include "problems/basic_graph/csr_graph.h"
 #include "problems/basic_tree/basic_tree.h"
 #include "problems/basic_tree/basic_tree_generator.h"
+#include "problems/basic_tree/csr_tree.h"
+#include "problems/basic_tree/implicit_tree.h"
+#include "problems/basic_tree/implicit_tree_generator.h"
+#include "problems/basic_tree/random_branching.h"
 #include "problems/basic_tree/tree_state.h"
 
 #endif //PARALLEL_BFS_PROJECT_PROBLEMS_H
@@ -7,20 +7,52 @@
 
 #include <vector>
 #include <unordered_set>
-#include <numeric>
+#include <limits>
+#include <algorithm>
 #include <yaml-cpp/yaml.h>
 #include <parallel_bfs/problem_utils.h>
 #include "../problems_common.h"
 
 
+namespace parallel_bfs::detail {
+    /// Degree statistics of a graph, accumulated one node at a time (e.g. while the graph is being written).
+    struct GraphStatistics {
+        std::size_t max_out_degree{0};
+        std::size_t min_out_degree{std::numeric_limits<std::size_t>::max()};
+        std::size_t num_nodes{0};
+        std::size_t num_edges{0};
+
+        void add(std::size_t out_degree) noexcept {
+            max_out_degree = std::max(max_out_degree, out_degree);
+            min_out_degree = std::min(min_out_degree, out_degree);
+            ++num_nodes;
+            num_edges += out_degree;
+        }
+
+        [[nodiscard]] double avg_out_degree() const noexcept {
+            return static_cast<double>(num_edges) / static_cast<double>(num_nodes);
+        }
+    };
+
+
+    /// Writes @stats as entries of the YAML map that is currently open in @out.
+    inline void emit_statistics(YAML::Emitter &out, const GraphStatistics &stats) {
+        out << YAML::Key << "max out-degree" << YAML::Value << stats.max_out_degree;
+        out << YAML::Key << "min out-degree" << YAML::Value << stats.min_out_degree;
+        out << YAML::Key << "avg out-degree" << YAML::Value << stats.avg_out_degree();
+    }
+}
+
+
+
 namespace parallel_bfs {
     template<detail::UnsignedInteger T>
-    class BasicGraph : public TransitionModel<T, T> {
+    class BasicGraph : public TransitionModel<T, T>, public SuccessorGenerator<BasicGraph<T>, T> {
         using graph_t = std::vector<std::unordered_set<T>>;
 
     public:
         [[nodiscard]] std::vector<T> actions(const T &state) const override {
-            auto states = _graph.at(state);
+            const auto &states = _graph.at(state);
             return {states.cbegin(), states.cend()};
         }
 
@@ -32,6 +64,11 @@ namespace parallel_bfs {
             return action;
         }
 
+        template<typename F>
+        void visit_successors(const T &state, F &&visitor) const {
+            for (const T next: _graph.at(state)) visitor(T{next}, 1);
+        }
+
         explicit BasicGraph() = default;
 
         explicit BasicGraph(std::size_t graph_size) : _graph(graph_size) {}
@@ -58,32 +95,17 @@ namespace parallel_bfs {
 
         [[nodiscard]] typename graph_t::const_iterator end() const { return _graph.end(); }
 
-        [[nodiscard]] std::size_t max_out_degree() const {
-            return std::transform_reduce(
-                    _graph.cbegin(), _graph.cend(),
-                    0,
-                    [](std::size_t acc, std::size_t s) { return std::max(acc, s); },
-                    [](const std::unordered_set<T> &s) { return s.size(); }
-            );
-        }
+        [[nodiscard]] std::size_t max_out_degree() const { return statistics().max_out_degree; }
 
-        [[nodiscard]] std::size_t min_out_degree() const {
-            return std::transform_reduce(
-                    _graph.cbegin(), _graph.cend(),
-                    std::numeric_limits<std::size_t>::max(),
-                    [](std::size_t acc, std::size_t s) { return std::min(acc, s); },
-                    [](const std::unordered_set<T> &s) { return s.size(); }
-            );
-        }
+        [[nodiscard]] std::size_t min_out_degree() const { return statistics().min_out_degree; }
 
-        [[nodiscard]] double avg_out_degree() const {
-            std::size_t sum = std::transform_reduce(
-                    _graph.cbegin(), _graph.cend(),
-                    0,
-                    std::plus<>(),
-                    [](const std::unordered_set<T> &s) { return s.size(); }
-            );
-            return static_cast<double>(sum) / _graph.size();
+        [[nodiscard]] double avg_out_degree() const { return statistics().avg_out_degree(); }
+
+        /// Computes all the degree statistics of the graph in a single pass.
+        [[nodiscard]] detail::GraphStatistics statistics() const {
+            detail::GraphStatistics stats;
+            for (const auto &edges: _graph) stats.add(edges.size());
+            return stats;
         }
 
     private:
@@ -99,17 +121,19 @@ namespace YAML {
         static Node encode(const parallel_bfs::BasicGraph<T> &rhs) {
             Node output_node(NodeType::Map);
             Node graph_nodes(NodeType::Map);
+            parallel_bfs::detail::GraphStatistics stats;
 
             for (size_t i = 0; i < rhs.size(); ++i) {
+                stats.add(rhs[i].size());
                 Node graph_edges(NodeType::Sequence);
                 graph_edges = rhs[i];
                 graph_nodes[i] = graph_edges;
                 graph_edges.SetStyle(YAML::EmitterStyle::Flow);
             }
 
-            output_node["max out-degree"] = rhs.max_out_degree();
-            output_node["min out-degree"] = rhs.min_out_degree();
-            output_node["avg out-degree"] = rhs.avg_out_degree();
+            output_node["max out-degree"] = stats.max_out_degree;
+            output_node["min out-degree"] = stats.min_out_degree;
+            output_node["avg out-degree"] = stats.avg_out_degree();
             output_node["graph"] = graph_nodes;
             return output_node;
         }
@@ -131,18 +155,21 @@ namespace YAML {
     };
 
 
+    /// Streams the graph node by node. The statistics are computed in the same pass, so they are written after it.
     template<parallel_bfs::ConvertibleToYAML T>
-    Emitter &operator<<(Emitter &out, const parallel_bfs::BasicGraph<T> graph) {
+    Emitter &operator<<(Emitter &out, const parallel_bfs::BasicGraph<T> &graph) {
+        parallel_bfs::detail::GraphStatistics stats;
         out << YAML::BeginMap;
-        out << YAML::Key << "max out-degree" << YAML::Value << graph.max_out_degree();
-        out << YAML::Key << "min out-degree" << YAML::Value << graph.min_out_degree();
-        out << YAML::Key << "avg out-degree" << YAML::Value << graph.avg_out_degree();
         out << YAML::Key << "graph" << YAML::Value << YAML::BeginMap;
 
-        for (size_t i = 0; i < graph.size(); ++i)
+        for (size_t i = 0; i < graph.size(); ++i) {
+            stats.add(graph[i].size());
             out << YAML::Key << i << YAML::Value << YAML::Flow << graph[i];
+        }
 
-        out << YAML::EndMap << YAML::EndMap;
+        out << YAML::EndMap;
+        parallel_bfs::detail::emit_statistics(out, stats);
+        out << YAML::EndMap;
         return out;
     }
 }
@@ -0,0 +1,186 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_CSR_GRAPH_H
+#define PARALLEL_BFS_PROJECT_CSR_GRAPH_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+#include <parallel_bfs/problem_utils.h>
+#include "basic_graph.h"
+#include "../csr_arrays.h"
+#include "../problems_common.h"
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Immutable Compressed Sparse Row (CSR) representation of a BasicGraph.
+     *
+     * The edges of all the nodes are stored contiguously in a single array, and the edges of node i are found in the
+     * range [offsets[i], offsets[i+1]). Successors can be queried as a std::span without any allocation. The arrays
+     * can also be the ones of a memory-mapped file (see BinaryReader).
+     */
+    template<detail::UnsignedInteger T>
+    class CsrGraph : public TransitionModel<T, T>, public SuccessorGenerator<CsrGraph<T>, T> {
+    public:
+        [[nodiscard]] std::vector<T> actions(const T &state) const override {
+            auto states = successors(state);
+            return {states.begin(), states.end()};
+        }
+
+        [[nodiscard]] int action_cost([[maybe_unused]] const T &current, [[maybe_unused]] const T &action, [[maybe_unused]] const T &next) const override {
+            return 1;
+        }
+
+        [[nodiscard]] T result([[maybe_unused]] const T &state, const T &action) const override {
+            return action;
+        }
+
+        template<typename F>
+        void visit_successors(const T &state, F &&visitor) const {
+            for (const T next: successors(state)) visitor(T{next}, 1);
+        }
+
+        explicit CsrGraph() = default;
+
+        explicit CsrGraph(const BasicGraph<T> &graph) {
+            std::vector<std::size_t> offsets;
+            std::vector<T> edges;
+            offsets.reserve(graph.size() + 1);
+            offsets.push_back(0);
+            for (const auto &node_edges: graph) {
+                edges.insert(edges.end(), node_edges.cbegin(), node_edges.cend());
+                offsets.push_back(edges.size());
+            }
+            _arrays = detail::CsrArrays<T>{std::move(offsets), std::move(edges)};
+        }
+
+        /// Builds the graph directly from its CSR arrays. @offsets must have one more element than the number of nodes.
+        explicit CsrGraph(std::vector<std::size_t> offsets, std::vector<T> edges)
+                : _arrays{std::move(offsets), std::move(edges)} {}
+
+        /// Builds the graph on top of existing CSR arrays (e.g. the ones of a memory-mapped file).
+        explicit CsrGraph(detail::CsrArrays<T> arrays) : _arrays{std::move(arrays)} {}
+
+        [[nodiscard]] std::span<const T> successors(const T &state) const {
+            if (state >= size()) throw std::out_of_range("State does not belong to the graph.");
+            return _arrays.row(state);
+        }
+
+        [[nodiscard]] std::size_t size() const { return _arrays.num_nodes(); }
+
+        [[nodiscard]] std::size_t num_edges() const { return _arrays.edges().size(); }
+
+        /**
+         * @brief Graph with the direction of every edge reversed, i.e. the predecessors of each node.
+         *
+         * It is built with a counting sort, O(nodes + edges), the first time that it is requested, and then shared by
+         * all the copies of this graph. Thread-safe.
+         */
+        [[nodiscard]] CsrGraph reversed() const {
+            std::call_once(_reverse->once, [this] { _reverse->arrays = reverse_arrays(); });
+            return CsrGraph{*_reverse->arrays};
+        }
+
+        [[nodiscard]] std::span<const std::size_t> offsets() const { return _arrays.offsets(); }
+
+        [[nodiscard]] std::span<const T> edges() const { return _arrays.edges(); }
+
+        [[nodiscard]] BasicGraph<T> to_basic_graph() const {
+            BasicGraph<T> graph(size());
+            for (std::size_t i = 0; i < size(); ++i) {
+                auto states = successors(static_cast<T>(i));
+                graph[i] = std::unordered_set<T>(states.begin(), states.end());
+            }
+            return graph;
+        }
+
+    private:
+        struct ReverseCache {
+            std::once_flag once;
+            std::optional<detail::CsrArrays<T>> arrays;
+        };
+
+        [[nodiscard]] detail::CsrArrays<T> reverse_arrays() const {
+            std::vector<std::size_t> offsets(size() + 1, 0);
+            for (const T next: edges()) {
+                if (next >= size()) throw std::out_of_range("Edge to a state that does not belong to the graph.");
+                ++offsets[next + 1];
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<T> reverse_edges(num_edges());
+            std::vector<std::size_t> positions(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < size(); ++i) {
+                for (const T next: _arrays.row(i)) reverse_edges[positions[next]++] = static_cast<T>(i);
+            }
+            return detail::CsrArrays<T>{std::move(offsets), std::move(reverse_edges)};
+        }
+
+        detail::CsrArrays<T> _arrays{};
+        std::shared_ptr<ReverseCache> _reverse{std::make_shared<ReverseCache>()}; // Shared by copies, like _arrays
+    };
+
+
+    template<detail::UnsignedInteger T>
+    struct BinaryCodec<CsrGraph<T>> {
+        using value_type = T;
+        static constexpr BinaryTypeTag tag = BinaryTypeTag::CsrGraph;
+
+        [[nodiscard]] static std::span<const std::size_t> offsets(const CsrGraph<T> &graph) { return graph.offsets(); }
+
+        [[nodiscard]] static std::span<const T> edges(const CsrGraph<T> &graph) { return graph.edges(); }
+
+        [[nodiscard]] static CsrGraph<T> make(std::shared_ptr<const void> owner, std::span<const std::size_t> offsets, std::span<const T> edges) {
+            return CsrGraph<T>{detail::CsrArrays<T>{std::move(owner), offsets, edges}};
+        }
+    };
+}
+
+
+
+namespace YAML {
+    /// The CSR graph uses the same YAML representation as BasicGraph.
+    template<parallel_bfs::ConvertibleToYAML T>
+    struct convert<parallel_bfs::CsrGraph<T>> {
+        static Node encode(const parallel_bfs::CsrGraph<T> &rhs) {
+            return convert<parallel_bfs::BasicGraph<T>>::encode(rhs.to_basic_graph());
+        }
+
+        static bool decode(const Node &node, parallel_bfs::CsrGraph<T> &rhs) {
+            parallel_bfs::BasicGraph<T> graph;
+            if (!convert<parallel_bfs::BasicGraph<T>>::decode(node, graph)) return false;
+            rhs = parallel_bfs::CsrGraph<T>{graph};
+            return true;
+        }
+    };
+
+
+    /// Streams the graph straight from the CSR arrays, without building a BasicGraph.
+    template<parallel_bfs::ConvertibleToYAML T>
+    Emitter &operator<<(Emitter &out, const parallel_bfs::CsrGraph<T> &graph) {
+        parallel_bfs::detail::GraphStatistics stats;
+        out << YAML::BeginMap;
+        out << YAML::Key << "graph" << YAML::Value << YAML::BeginMap;
+        for (std::size_t i = 0; i < graph.size(); ++i) {
+            const auto states = graph.successors(static_cast<T>(i));
+            stats.add(states.size());
+            out << YAML::Key << i << YAML::Value << YAML::Flow << YAML::BeginSeq;
+            for (const T state: states) out << state;
+            out << YAML::EndSeq;
+        }
+        out << YAML::EndMap;
+        parallel_bfs::detail::emit_statistics(out, stats);
+        out << YAML::EndMap;
+        return out;
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_CSR_GRAPH_H
@@ -7,21 +7,66 @@
 
 #include <unordered_map>
 #include <unordered_set>
-#include <numeric>
+#include <algorithm>
 #include <yaml-cpp/yaml.h>
 #include <parallel_bfs/problem_utils.h>
 #include "tree_state.h"
 #include "../problems_common.h"
 
 
+namespace parallel_bfs::detail {
+    /// Shape statistics of a tree, accumulated one node at a time (e.g. while the tree is being written).
+    struct TreeStatistics {
+        std::size_t max_depth{0};
+        std::size_t max_branch_factor{0};
+        std::size_t leaf_nodes{0};
+        std::size_t leaf_depth_sum{0};
+        std::size_t internal_nodes{0};
+        std::size_t num_edges{0};
+
+        void add(std::size_t depth, std::size_t branch_factor) noexcept {
+            max_depth = std::max(max_depth, depth);
+            max_branch_factor = std::max(max_branch_factor, branch_factor);
+            if (branch_factor == 0) {
+                ++leaf_nodes;
+                leaf_depth_sum += depth;
+            } else {
+                ++internal_nodes;
+                num_edges += branch_factor;
+            }
+        }
+
+        /// Average depth of leaf nodes.
+        [[nodiscard]] double avg_depth() const noexcept {
+            return static_cast<double>(leaf_depth_sum) / static_cast<double>(leaf_nodes);
+        }
+
+        /// Average branching factor of internal nodes.
+        [[nodiscard]] double avg_branch_factor() const noexcept {
+            return static_cast<double>(num_edges) / static_cast<double>(internal_nodes);
+        }
+    };
+
+
+    /// Writes @stats as entries of the YAML map that is currently open in @out.
+    inline void emit_statistics(YAML::Emitter &out, const TreeStatistics &stats) {
+        out << YAML::Key << "max depth" << YAML::Value << stats.max_depth;
+        out << YAML::Key << "avg depth" << YAML::Value << stats.avg_depth();
+        out << YAML::Key << "max branch factor" << YAML::Value << stats.max_branch_factor;
+        out << YAML::Key << "avg branch factor" << YAML::Value << stats.avg_branch_factor();
+    }
+}
+
+
+
 namespace parallel_bfs {
     template<detail::UnsignedInteger T>
-    class BasicTree : public TransitionModel<TreeState<T>, T> {
+    class BasicTree : public TransitionModel<TreeState<T>, T>, public SuccessorGenerator<BasicTree<T>, TreeState<T>> {
         using tree_t = std::unordered_map<TreeState<T>, std::unordered_set<T>>;
 
     public:
         [[nodiscard]] std::vector<T> actions(const TreeState<T> &state) const override {
-            auto states = _tree.at(state);
+            const auto &states = _tree.at(state);
             return {states.cbegin(), states.cend()};
         }
 
@@ -34,6 +79,11 @@ namespace parallel_bfs {
             return TreeState{state, action};
         }
 
+        template<typename F>
+        void visit_successors(const TreeState<T> &state, F &&visitor) const {
+            for (const T action: _tree.at(state)) visitor(TreeState{state, action}, 1);
+        }
+
         explicit BasicTree() = default;
 
         explicit BasicTree(std::size_t tree_size) { _tree.reserve(tree_size); }
@@ -46,6 +96,9 @@ namespace parallel_bfs {
 
         void erase(const TreeState<T> &key) { _tree.erase(key); }
 
+        /// Moves the nodes of @other into this tree (without copying them). Nodes already in this tree are kept.
+        void merge(BasicTree &&other) { _tree.merge(other._tree); }
+
         [[nodiscard]] std::size_t size() const { return _tree.size(); }
 
         void reserve(std::size_t count) { _tree.reserve(count); }
@@ -58,58 +111,21 @@ namespace parallel_bfs {
 
         [[nodiscard]] typename tree_t::const_iterator end() const { return _tree.end(); }
 
-        [[nodiscard]] std::size_t max_depth() const {
-            return std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    [](std::size_t acc, std::size_t s) { return std::max(acc, s); },
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) { return kv.first.depth(); }
-            );
-        }
+        [[nodiscard]] std::size_t max_depth() const { return statistics().max_depth; }
 
         /// Returns the average depth of leaf nodes.
-        [[nodiscard]] double avg_depth() const {
-            std::size_t sum = std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    std::plus<>(),
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) {
-                        return kv.second.size() == 0 ? kv.first.depth() : 0;
-                    }
-            );
-            std::size_t leaf_node_count = std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    std::plus<>(),
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) { return kv.second.size() == 0 ? 1 : 0; }
-            );
-            return static_cast<double>(sum) / static_cast<double>(leaf_node_count);
-        }
+        [[nodiscard]] double avg_depth() const { return statistics().avg_depth(); }
 
-        [[nodiscard]] std::size_t max_branch_factor() const {
-            return std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    [](std::size_t acc, std::size_t s) { return std::max(acc, s); },
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) { return kv.second.size(); }
-            );
-        }
+        [[nodiscard]] std::size_t max_branch_factor() const { return statistics().max_branch_factor; }
 
         /// Returns the average branching factor of internal nodes.
-        [[nodiscard]] double avg_branch_factor() const {
-            std::size_t sum = std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    std::plus<>(),
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) { return kv.second.size(); }
-            );
-            std::size_t internal_node_count = std::transform_reduce(
-                    _tree.cbegin(), _tree.cend(),
-                    0,
-                    std::plus<>(),
-                    [](const std::pair<TreeState<T>, std::unordered_set<T>> &kv) { return kv.second.size() == 0 ? 0 : 1; }
-            );
-            return static_cast<double>(sum) / static_cast<double>(internal_node_count);
+        [[nodiscard]] double avg_branch_factor() const { return statistics().avg_branch_factor(); }
+
+        /// Computes all the shape statistics of the tree in a single pass.
+        [[nodiscard]] detail::TreeStatistics statistics() const {
+            detail::TreeStatistics stats;
+            for (const auto &[state, actions]: _tree) stats.add(state.depth(), actions.size());
+            return stats;
         }
 
     private:
@@ -124,18 +140,20 @@ namespace YAML {
         static Node encode(const parallel_bfs::BasicTree <T> &rhs) {
             Node output_node(NodeType::Map);
             Node tree_nodes(NodeType::Map);
+            parallel_bfs::detail::TreeStatistics stats;
 
             for (const auto &[key, value]: rhs) {
+                stats.add(key.depth(), value.size());
                 Node tree_children(NodeType::Sequence);
                 tree_children = value;
                 tree_nodes[key] = tree_children;
                 tree_children.SetStyle(YAML::EmitterStyle::Flow);
             }
 
-            output_node["max depth"] = rhs.max_depth();
-            output_node["avg depth"] = rhs.avg_depth();
-            output_node["max branch factor"] = rhs.max_branch_factor();
-            output_node["avg branch factor"] = rhs.avg_branch_factor();
+            output_node["max depth"] = stats.max_depth;
+            output_node["avg depth"] = stats.avg_depth();
+            output_node["max branch factor"] = stats.max_branch_factor;
+            output_node["avg branch factor"] = stats.avg_branch_factor();
             output_node["tree"] = tree_nodes;
             return output_node;
         }
@@ -157,19 +175,21 @@ namespace YAML {
     };
 
 
+    /// Streams the tree node by node. The statistics are computed in the same pass, so they are written after it.
     template<parallel_bfs::ConvertibleToYAML T>
-    Emitter &operator<<(Emitter &out, const parallel_bfs::BasicTree<T> tree) {
+    Emitter &operator<<(Emitter &out, const parallel_bfs::BasicTree<T> &tree) {
+        parallel_bfs::detail::TreeStatistics stats;
         out << YAML::BeginMap;
-        out << YAML::Key << "max depth" << YAML::Value << tree.max_depth();
-        out << YAML::Key << "avg depth" << YAML::Value << tree.avg_depth();
-        out << YAML::Key << "max branch factor" << YAML::Value << tree.max_branch_factor();
-        out << YAML::Key << "avg branch factor" << YAML::Value << tree.avg_branch_factor();
         out << YAML::Key << "tree" << YAML::Value << YAML::BeginMap;
 
-        for (const auto &[key, value]: tree)
+        for (const auto &[key, value]: tree) {
+            stats.add(key.depth(), value.size());
             out << YAML::Key << key << YAML::Value << YAML::Flow << value;
+        }
 
-        out << YAML::EndMap << YAML::EndMap;
+        out << YAML::EndMap;
+        parallel_bfs::detail::emit_statistics(out, stats);
+        out << YAML::EndMap;
         return out;
     }
 }
@@ -6,15 +6,16 @@
 #define PARALLEL_BFS_PROJECT_BASIC_TREE_GENERATOR_H
 
 #include <queue>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cmath>
 #include <algorithm>
 #include "tree_state.h"
 #include "basic_tree.h"
+#include "random_branching.h"
 #include "../problems_common.h"
-
-
-namespace parallel_bfs::detail {
-    enum class BranchingDistribution { Uniform, Binomial };
-}
+#include "../../search/thread_pool.h"
 
 
 namespace parallel_bfs {
@@ -71,6 +72,25 @@ namespace parallel_bfs {
                     "The number of goals must be lower or equal to the maximum number of different states in the tree.");
         }
 
+        /**
+         * @brief Generates the trees of the following problems in parallel on @pool (or serially, if it is null).
+         *
+         * Every node of a tree is generated from its own random stream, derived from the seed of the problem and the
+         * state, so a problem only depends on its seed and not on the number of threads used to generate it.
+         * @warning make_problem() must not be called from a worker of @pool.
+         */
+        void set_thread_pool(std::shared_ptr<ThreadPool> pool) { _pool = std::move(pool); }
+
+        /// Rule that decides the actions of each node of the generated trees.
+        [[nodiscard]] detail::RandomBranching<T> branching() const {
+            return detail::RandomBranching<T>{_max_depth, _bdist, _min_bfactor, _avg_bfactor, _max_bfactor};
+        }
+
+        /// Number of nodes that the generated trees are expected to have, with a 10% margin (to avoid rehashing).
+        [[nodiscard]] std::size_t expected_size() const {
+            return static_cast<std::size_t>(pow(_avg_bfactor, _max_depth) * 1.1);
+        }
+
     protected:
         [[nodiscard]] TreeState<T> get_initial() override { return TreeState<T>{}; }
 
@@ -86,27 +106,9 @@ namespace parallel_bfs {
 
         /// Builds an Adjacency List representation of a tree.
         [[nodiscard]] BasicTree<T> get_transition_model() override {
-            // Create an empty tree
-            auto expected_size = static_cast<std::size_t>(pow(_avg_bfactor, _max_depth) * 1.1); // 10% more than needed to avoid rehashing
-            BasicTree<T> tree(expected_size);
-
-            // Fill the graph using Breadth-First-Search
-            std::queue<TreeState<T>> frontier({TreeState<T>{}});
-            tree.insert(TreeState<T>{}, std::unordered_set<T>());
-
-            while (!frontier.empty()) {
-                TreeState<T> state{frontier.front()};
-                frontier.pop();
-                if (state.depth() == _max_depth) break; // Stop once we reach max_depth
-                for (const auto action: get_random_actions()) {
-                    TreeState<T> child{state, action};
-                    tree.insert(child, std::unordered_set<T>());
-                    frontier.push(child);
-                    tree[state].insert(action);
-                }
-            }
-
-            return BasicTree<T>{std::move(tree)};
+            std::uniform_int_distribution<std::uint64_t> seed_dist;
+            const std::uint64_t tree_seed = this->get_random_value(seed_dist);
+            return _pool ? make_tree(tree_seed, *_pool) : make_tree(tree_seed);
         }
 
     private:
@@ -117,7 +119,7 @@ namespace parallel_bfs {
         const unsigned int _min_bfactor;
         const unsigned int _max_bfactor;
         const detail::BranchingDistribution _bdist;
-        const std::vector<T> _possible_actions {get_possible_actions(_max_bfactor)};
+        std::shared_ptr<ThreadPool> _pool{nullptr};
 
         [[nodiscard]] TreeState<T> get_random_goal() {
             // // Randomly select a depth for the goal state
@@ -131,24 +133,57 @@ namespace parallel_bfs {
             return TreeState{goal_path};
         }
 
-        [[nodiscard]] std::vector<T> get_random_actions() {
-            if (_bdist == detail::BranchingDistribution::Uniform) {
-                std::uniform_int_distribution<unsigned int> dist{_min_bfactor, _max_bfactor};
-                unsigned int branch_factor = this->get_random_value(dist);
-                return this->get_random_sample(_possible_actions, branch_factor);
-            } else if (_bdist == detail::BranchingDistribution::Binomial) {
-                std::binomial_distribution<unsigned int> dist{_max_bfactor, _avg_bfactor / _max_bfactor};
-                unsigned int branch_factor = this->get_random_value(dist);
-                return this->get_random_sample(_possible_actions, branch_factor);
-            } else {
-                throw std::invalid_argument("Invalid branching distribution selected.");
+        /// Actions of @state in the tree identified by @tree_seed. Subtrees can be generated in any order, and the
+        /// tree is the same as ImplicitTree{tree_seed, branching()}.
+        [[nodiscard]] std::vector<T> get_random_actions(std::uint64_t tree_seed, const TreeState<T> &state) const {
+            return branching().actions(tree_seed, state);
+        }
+
+        /// Adds @root and all its descendants to @tree, in breadth-first order.
+        void grow_subtree(std::uint64_t tree_seed, TreeState<T> root, BasicTree<T> &tree) const {
+            std::queue<TreeState<T>> frontier;
+            frontier.push(std::move(root));
+            while (!frontier.empty()) {
+                TreeState<T> state{std::move(frontier.front())};
+                frontier.pop();
+                const auto actions = get_random_actions(tree_seed, state);
+                for (const auto action: actions) frontier.emplace(state, action);
+                tree.insert(state, std::unordered_set<T>(actions.begin(), actions.end()));
             }
         }
 
-        [[nodiscard]] static std::vector<T> get_possible_actions(T n) {
-            std::vector<T> output(n);
-            std::iota(output.begin(), output.end(), 0);
-            return output;
+        [[nodiscard]] BasicTree<T> make_tree(std::uint64_t tree_seed) const {
+            BasicTree<T> tree(expected_size());
+            grow_subtree(tree_seed, TreeState<T>{}, tree);
+            return tree;
+        }
+
+        /// Generates the top levels of the tree until there are enough subtrees to balance the load, and then each
+        /// worker of @pool grows a share of the subtrees into a tree of its own. The result is the same as make_tree().
+        [[nodiscard]] BasicTree<T> make_tree(std::uint64_t tree_seed, ThreadPool &pool) const {
+            constexpr std::size_t subtrees_per_thread = 16;
+            BasicTree<T> tree(expected_size());
+
+            std::vector<TreeState<T>> roots{TreeState<T>{}};
+            while (!roots.empty() && roots.size() < subtrees_per_thread * pool.size()) {
+                std::vector<TreeState<T>> next_roots;
+                for (const auto &state: roots) {
+                    const auto actions = get_random_actions(tree_seed, state);
+                    for (const auto action: actions) next_roots.emplace_back(state, action);
+                    tree.insert(state, std::unordered_set<T>(actions.begin(), actions.end()));
+                }
+                roots = std::move(next_roots);
+            }
+
+            std::vector<BasicTree<T>> subtrees;
+            subtrees.reserve(pool.size());
+            for (unsigned int i = 0; i < pool.size(); ++i) subtrees.emplace_back(expected_size() / pool.size());
+            pool.run_on_all([this, tree_seed, &pool, &roots, &subtrees](unsigned int id) {
+                for (std::size_t i = id; i < roots.size(); i += pool.size()) grow_subtree(tree_seed, roots[i], subtrees[id]);
+            });
+
+            for (auto &subtree: subtrees) tree.merge(std::move(subtree));
+            return tree;
         }
     };
 }
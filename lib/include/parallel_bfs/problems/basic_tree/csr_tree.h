@@ -0,0 +1,199 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_CSR_TREE_H
+#define PARALLEL_BFS_PROJECT_CSR_TREE_H
+
+#include <vector>
+#include <span>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+#include <parallel_bfs/problem_utils.h>
+#include "tree_state.h"
+#include "basic_tree.h"
+#include "../csr_arrays.h"
+#include "../problems_common.h"
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Immutable Compressed Sparse Row (CSR) representation of a BasicTree.
+     *
+     * Nodes are numbered in breadth-first order starting at the root, and the actions of all of them are stored
+     * contiguously in a single array: the actions of node i are found in the range [offsets[i], offsets[i+1]).
+     * Because of the breadth-first numbering, the k-th action of the array leads to node k+1. Successors can be
+     * queried as a std::span without any allocation.
+     *
+     * The states created by the tree carry the index of their node (see TreeState::index), so their successors are
+     * found in O(1). The index of any other state (e.g. a goal read from a file) is found by following its path from
+     * the root. Therefore, the tree needs no other data structure than its two arrays, and it can use the arrays of a
+     * memory-mapped file in place (see BinaryReader).
+     */
+    template<detail::UnsignedInteger T>
+    class CsrTree : public TransitionModel<TreeState<T>, T>, public SuccessorGenerator<CsrTree<T>, TreeState<T>> {
+    public:
+        [[nodiscard]] std::vector<T> actions(const TreeState<T> &state) const override {
+            auto actions = successors(state);
+            return {actions.begin(), actions.end()};
+        }
+
+        [[nodiscard]] int
+        action_cost([[maybe_unused]] const TreeState<T> &current, [[maybe_unused]] const T &action, [[maybe_unused]] const TreeState<T> &next) const override {
+            return 1;
+        }
+
+        [[nodiscard]] TreeState<T> result(const TreeState<T> &state, const T &action) const override {
+            return TreeState{state, action, child_index(index_of(state), action)};
+        }
+
+        template<typename F>
+        void visit_successors(const TreeState<T> &state, F &&visitor) const {
+            const auto actions = successors(state);
+            const std::size_t first_child = static_cast<std::size_t>(actions.data() - _arrays.edges().data()) + 1;
+            for (std::size_t i = 0; i < actions.size(); ++i) visitor(TreeState{state, actions[i], first_child + i}, 1);
+        }
+
+        explicit CsrTree() = default;
+
+        /// Builds the CSR representation of the nodes of @tree reachable from the root.
+        explicit CsrTree(const BasicTree<T> &tree) {
+            std::vector<std::size_t> offsets;
+            std::vector<T> edges;
+            offsets.reserve(tree.size() + 1);
+            offsets.push_back(0);
+
+            std::queue<TreeState<T>> frontier({TreeState<T>{}});
+            while (!frontier.empty()) {
+                TreeState<T> state{std::move(frontier.front())};
+                frontier.pop();
+                for (const T action: tree[state]) {
+                    edges.push_back(action);
+                    frontier.emplace(state, action);
+                }
+                offsets.push_back(edges.size());
+            }
+            _arrays = detail::CsrArrays<T>{std::move(offsets), std::move(edges)};
+        }
+
+        /// Builds the tree directly from its CSR arrays, which must follow the breadth-first numbering.
+        explicit CsrTree(std::vector<std::size_t> offsets, std::vector<T> edges)
+                : CsrTree{detail::CsrArrays<T>{std::move(offsets), std::move(edges)}} {}
+
+        /// Builds the tree on top of existing CSR arrays (e.g. the ones of a memory-mapped file).
+        explicit CsrTree(detail::CsrArrays<T> arrays) : _arrays{std::move(arrays)} {
+            if (_arrays.edges().size() + 1 != size()) throw std::invalid_argument("Invalid CSR offsets.");
+        }
+
+        [[nodiscard]] std::span<const T> successors(const TreeState<T> &state) const {
+            return _arrays.row(index_of(state));
+        }
+
+        [[nodiscard]] std::size_t size() const { return _arrays.num_nodes(); }
+
+        [[nodiscard]] std::span<const std::size_t> offsets() const { return _arrays.offsets(); }
+
+        [[nodiscard]] std::span<const T> edges() const { return _arrays.edges(); }
+
+        [[nodiscard]] BasicTree<T> to_basic_tree() const {
+            BasicTree<T> tree(size());
+            std::vector<TreeState<T>> states;
+            states.reserve(size());
+            states.emplace_back();
+            for (std::size_t i = 0; i < size(); ++i) {
+                const auto actions = _arrays.row(i);
+                for (const T action: actions) states.emplace_back(states[i], action);
+                tree.insert(states[i], std::unordered_set<T>(actions.begin(), actions.end()));
+            }
+            return tree;
+        }
+
+    private:
+        /// Index stored in @state, or found by following its path from the root otherwise.
+        [[nodiscard]] std::size_t index_of(const TreeState<T> &state) const {
+            if (const auto index = state.index(); index.has_value()) return index.value();
+            std::size_t node = 0;
+            state.visit_path([this, &node](T action) { node = child_index(node, action); });
+            return node;
+        }
+
+        /// Index of the child of node @node reached with @action. It is a linear search among the actions of @node.
+        [[nodiscard]] std::size_t child_index(std::size_t node, T action) const {
+            const auto actions = _arrays.row(node);
+            const auto it = std::find(actions.begin(), actions.end(), action);
+            if (it == actions.end()) throw std::out_of_range("State does not belong to the tree.");
+            return static_cast<std::size_t>(&*it - _arrays.edges().data()) + 1;
+        }
+
+        detail::CsrArrays<T> _arrays{};
+    };
+
+
+    template<detail::UnsignedInteger T>
+    struct BinaryCodec<CsrTree<T>> {
+        using value_type = T;
+        static constexpr BinaryTypeTag tag = BinaryTypeTag::CsrTree;
+
+        [[nodiscard]] static std::span<const std::size_t> offsets(const CsrTree<T> &tree) { return tree.offsets(); }
+
+        [[nodiscard]] static std::span<const T> edges(const CsrTree<T> &tree) { return tree.edges(); }
+
+        [[nodiscard]] static CsrTree<T> make(std::shared_ptr<const void> owner, std::span<const std::size_t> offsets, std::span<const T> edges) {
+            return CsrTree<T>{detail::CsrArrays<T>{std::move(owner), offsets, edges}};
+        }
+    };
+}
+
+
+
+namespace YAML {
+    /// The CSR tree uses the same YAML representation as BasicTree.
+    template<parallel_bfs::ConvertibleToYAML T>
+    struct convert<parallel_bfs::CsrTree<T>> {
+        static Node encode(const parallel_bfs::CsrTree<T> &rhs) {
+            return convert<parallel_bfs::BasicTree<T>>::encode(rhs.to_basic_tree());
+        }
+
+        static bool decode(const Node &node, parallel_bfs::CsrTree<T> &rhs) {
+            parallel_bfs::BasicTree<T> tree;
+            if (!convert<parallel_bfs::BasicTree<T>>::decode(node, tree)) return false;
+            rhs = parallel_bfs::CsrTree<T>{tree};
+            return true;
+        }
+    };
+
+
+    /// Streams the tree in breadth-first order straight from the CSR arrays, without building a BasicTree. Only the
+    /// states of the nodes that have not been written yet are kept in memory.
+    template<parallel_bfs::ConvertibleToYAML T>
+    Emitter &operator<<(Emitter &out, const parallel_bfs::CsrTree<T> &tree) {
+        const auto offsets = tree.offsets();
+        const auto edges = tree.edges();
+        parallel_bfs::detail::TreeStatistics stats;
+        std::queue<parallel_bfs::TreeState<T>> pending({parallel_bfs::TreeState<T>{}});
+
+        out << YAML::BeginMap;
+        out << YAML::Key << "tree" << YAML::Value << YAML::BeginMap;
+        for (std::size_t i = 0; i < tree.size(); ++i) {
+            const parallel_bfs::TreeState<T> state{std::move(pending.front())};
+            pending.pop();
+            stats.add(state.depth(), offsets[i + 1] - offsets[i]);
+
+            out << YAML::Key << state << YAML::Value << YAML::Flow << YAML::BeginSeq;
+            for (std::size_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+                out << edges[e];
+                pending.emplace(state, edges[e]);
+            }
+            out << YAML::EndSeq;
+        }
+        out << YAML::EndMap;
+        parallel_bfs::detail::emit_statistics(out, stats);
+        out << YAML::EndMap;
+        return out;
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_CSR_TREE_H
@@ -0,0 +1,122 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_IMPLICIT_TREE_H
+#define PARALLEL_BFS_PROJECT_IMPLICIT_TREE_H
+
+#include <vector>
+#include <queue>
+#include <string>
+#include <cstdint>
+#include <unordered_set>
+#include <yaml-cpp/yaml.h>
+#include <parallel_bfs/problem_utils.h>
+#include "tree_state.h"
+#include "basic_tree.h"
+#include "random_branching.h"
+#include "../problems_common.h"
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Random tree whose edges are never stored: the actions of a state are computed when they are requested.
+     *
+     * The tree is fully described by a seed and the parameters of its branching distribution (see
+     * detail::RandomBranching), so its size is not limited by memory, and only the search itself uses memory. It is
+     * the same tree that BasicTreeGenerator builds with the same seed and parameters.
+     *
+     * @note Since nothing is stored, states that do not belong to the tree are not detected: they get actions too.
+     */
+    template<detail::UnsignedInteger T>
+    class ImplicitTree : public TransitionModel<TreeState<T>, T>, public SuccessorGenerator<ImplicitTree<T>, TreeState<T>> {
+    public:
+        [[nodiscard]] std::vector<T> actions(const TreeState<T> &state) const override {
+            return _branching.actions(_seed, state);
+        }
+
+        [[nodiscard]] int
+        action_cost([[maybe_unused]] const TreeState<T> &current, [[maybe_unused]] const T &action, [[maybe_unused]] const TreeState<T> &next) const override {
+            return 1;
+        }
+
+        [[nodiscard]] TreeState<T> result(const TreeState<T> &state, const T &action) const override {
+            return TreeState{state, action};
+        }
+
+        template<typename F>
+        void visit_successors(const TreeState<T> &state, F &&visitor) const {
+            _branching.visit_actions(_seed, state, [&state, &visitor](T action) { visitor(TreeState{state, action}, 1); });
+        }
+
+        explicit ImplicitTree() : ImplicitTree{0, detail::RandomBranching<T>{0, detail::BranchingDistribution::Uniform, 0, 0.0, 0}} {}
+
+        explicit ImplicitTree(std::uint64_t seed, detail::RandomBranching<T> branching) : _seed{seed}, _branching{branching} {}
+
+        [[nodiscard]] std::uint64_t seed() const { return _seed; }
+
+        [[nodiscard]] const detail::RandomBranching<T> &branching() const { return _branching; }
+
+        /// Stores every node of the tree. Only meant for small trees (e.g. to write them explicitly).
+        [[nodiscard]] BasicTree<T> to_basic_tree() const {
+            BasicTree<T> tree;
+            std::queue<TreeState<T>> frontier({TreeState<T>{}});
+            while (!frontier.empty()) {
+                TreeState<T> state{std::move(frontier.front())};
+                frontier.pop();
+                const auto actions = this->actions(state);
+                for (const T action: actions) frontier.emplace(state, action);
+                tree.insert(state, std::unordered_set<T>(actions.begin(), actions.end()));
+            }
+            return tree;
+        }
+
+    private:
+        std::uint64_t _seed;
+        detail::RandomBranching<T> _branching;
+    };
+}
+
+
+
+namespace YAML {
+    /// Only the seed and the parameters of the tree are written.
+    template<parallel_bfs::ConvertibleToYAML T>
+    struct convert<parallel_bfs::ImplicitTree<T>> {
+        static Node encode(const parallel_bfs::ImplicitTree<T> &rhs) {
+            const auto &branching = rhs.branching();
+            Node node(NodeType::Map);
+            node["seed"] = rhs.seed();
+            node["max depth"] = branching.max_depth();
+            node["distribution"] = branching.distribution() == parallel_bfs::detail::BranchingDistribution::Uniform ? "uniform" : "binomial";
+            node["min branch factor"] = branching.min_bfactor();
+            node["avg branch factor"] = branching.avg_bfactor();
+            node["max branch factor"] = branching.max_bfactor();
+            return node;
+        }
+
+        static bool decode(const Node &node, parallel_bfs::ImplicitTree<T> &rhs) {
+            if (!node.IsMap()) return false;
+            const auto distribution = node["distribution"].as<std::string>();
+            if (distribution != "uniform" && distribution != "binomial") return false;
+
+            parallel_bfs::detail::RandomBranching<T> branching{
+                    node["max depth"].as<unsigned int>(),
+                    distribution == "uniform" ? parallel_bfs::detail::BranchingDistribution::Uniform : parallel_bfs::detail::BranchingDistribution::Binomial,
+                    node["min branch factor"].as<unsigned int>(),
+                    node["avg branch factor"].as<double>(),
+                    node["max branch factor"].as<unsigned int>()
+            };
+            rhs = parallel_bfs::ImplicitTree<T>{node["seed"].as<std::uint64_t>(), branching};
+            return true;
+        }
+    };
+
+
+    template<parallel_bfs::ConvertibleToYAML T>
+    Emitter &operator<<(Emitter &out, const parallel_bfs::ImplicitTree<T> &tree) {
+        return out << convert<parallel_bfs::ImplicitTree<T>>::encode(tree);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_IMPLICIT_TREE_H
@@ -0,0 +1,83 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_IMPLICIT_TREE_GENERATOR_H
+#define PARALLEL_BFS_PROJECT_IMPLICIT_TREE_GENERATOR_H
+
+#include <random>
+#include <optional>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_set>
+#include "tree_state.h"
+#include "implicit_tree.h"
+#include "random_branching.h"
+#include "../problems_common.h"
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Generates problems on random implicit trees, which take O(1) memory regardless of their size.
+     *
+     * Goal states are found with random walks from the root, so, unlike with BasicTreeGenerator, all of them belong
+     * to the tree.
+     */
+    template<detail::UnsignedInteger T>
+    class ImplicitTreeGenerator : public RandomFactory<TreeState<T>, ImplicitTree<T>> {
+    public:
+        /// Trees with a binomial branching factor of mean @avg_bfactor. See BasicTreeGenerator.
+        explicit ImplicitTreeGenerator(unsigned int max_depth, unsigned int goals_depth, unsigned int num_goals, double avg_bfactor, unsigned int max_bfactor)
+                : ImplicitTreeGenerator{goals_depth, num_goals, detail::RandomBranching<T>{max_depth, detail::BranchingDistribution::Binomial, 0, avg_bfactor, max_bfactor}} {}
+
+        /// Trees with a branching factor uniformly distributed in [@min_bfactor, @max_bfactor]. See BasicTreeGenerator.
+        explicit ImplicitTreeGenerator(unsigned int max_depth, unsigned int goals_depth, unsigned int num_goals, unsigned int min_bfactor, unsigned int max_bfactor)
+                : ImplicitTreeGenerator{goals_depth, num_goals, detail::RandomBranching<T>{max_depth, detail::BranchingDistribution::Uniform, min_bfactor, (min_bfactor + max_bfactor) / 2.0, max_bfactor}} {}
+
+    protected:
+        [[nodiscard]] TreeState<T> get_initial() override { return TreeState<T>{}; }
+
+        /// ProblemFactory asks for the goals before the transition model, so the tree is drawn here.
+        [[nodiscard]] std::unordered_set<TreeState<T>> get_goal_states() override {
+            std::uniform_int_distribution<std::uint64_t> seed_dist;
+            _tree = ImplicitTree<T>{this->get_random_value(seed_dist), _branching};
+
+            std::unordered_set<TreeState<T>> goals(_num_goals);
+            const std::size_t max_walks = 1000 * static_cast<std::size_t>(_num_goals);
+            for (std::size_t walk = 0; goals.size() < _num_goals; ++walk) {
+                if (walk == max_walks) throw std::runtime_error("Could not find enough goal states in the tree.");
+                if (auto goal = random_walk()) goals.insert(std::move(*goal));
+            }
+            return goals;
+        }
+
+        [[nodiscard]] ImplicitTree<T> get_transition_model() override { return _tree; }
+
+    private:
+        explicit ImplicitTreeGenerator(unsigned int goals_depth, unsigned int num_goals, detail::RandomBranching<T> branching)
+                : _goals_depth{goals_depth}, _num_goals{num_goals}, _branching{branching} {
+            if (goals_depth > branching.max_depth())
+                throw std::invalid_argument(
+                    "The depth of the goal states must be lower or equal to the maximum depth of the tree.");
+        }
+
+        /// Follows random actions from the root down to the depth of the goals. Empty if the walk reaches a leaf before.
+        [[nodiscard]] std::optional<TreeState<T>> random_walk() {
+            TreeState<T> state;
+            while (state.depth() < _goals_depth) {
+                const auto actions = _tree.actions(state);
+                if (actions.empty()) return std::nullopt;
+                std::uniform_int_distribution<std::size_t> dist{0, actions.size() - 1};
+                state = TreeState<T>{state, actions[this->get_random_value(dist)]};
+            }
+            return state;
+        }
+
+        const unsigned int _goals_depth;
+        const unsigned int _num_goals;
+        const detail::RandomBranching<T> _branching;
+        ImplicitTree<T> _tree{};
+    };
+}
+
+#endif //PARALLEL_BFS_PROJECT_IMPLICIT_TREE_GENERATOR_H
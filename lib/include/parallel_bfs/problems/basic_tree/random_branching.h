@@ -0,0 +1,90 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_RANDOM_BRANCHING_H
+#define PARALLEL_BFS_PROJECT_RANDOM_BRANCHING_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <parallel_bfs/problem_utils.h>
+#include "tree_state.h"
+#include "../problems_common.h"
+
+
+namespace parallel_bfs::detail {
+    enum class BranchingDistribution { Uniform, Binomial };
+
+
+    /**
+     * @brief Rule that decides the actions of every node of a random tree.
+     *
+     * The actions of a node are drawn from a random stream of their own, seeded with the seed of the tree and the
+     * hash of the state. Therefore, they only depend on the seed and the state: trees can be generated in any order
+     * (e.g. by several threads), or never stored at all (see ImplicitTree). Actions are values in [0, max_bfactor),
+     * and the branching factor follows either a uniform distribution in [min_bfactor, max_bfactor], or a binomial
+     * distribution with mean avg_bfactor. Nodes at max_depth have no actions.
+     *
+     * All the draws are made directly from the SplitMix64 output, without the distributions of <random>, whose
+     * results depend on the standard library. Therefore, a seed describes the same tree on every platform. This matters
+     * for the problem files of implicit trees, since they only store the seed and the parameters of the tree.
+     */
+    template<UnsignedInteger T>
+    class RandomBranching {
+    public:
+        explicit RandomBranching(unsigned int max_depth, BranchingDistribution distribution, unsigned int min_bfactor, double avg_bfactor, unsigned int max_bfactor)
+                : _max_depth{max_depth}, _distribution{distribution}, _min_bfactor{min_bfactor}, _avg_bfactor{avg_bfactor}, _max_bfactor{max_bfactor} {
+            if (min_bfactor > max_bfactor || avg_bfactor > max_bfactor || avg_bfactor < 0)
+                throw std::invalid_argument("Invalid branching factors.");
+        }
+
+        /// Calls visitor(action) for each action of @state in the tree identified by @tree_seed, in increasing order.
+        template<typename F>
+        void visit_actions(std::uint64_t tree_seed, const TreeState<T> &state, F &&visitor) const {
+            if (state.depth() >= _max_depth || _max_bfactor == 0) return;
+            SplitMix64 engine{tree_seed ^ state.hash()};
+
+            unsigned int remaining = 0;
+            if (_distribution == BranchingDistribution::Uniform) {
+                remaining = _min_bfactor + engine.bounded(_max_bfactor - _min_bfactor + 1);
+            } else { // Binomial: one Bernoulli trial per possible action
+                const double p = _avg_bfactor / _max_bfactor;
+                for (unsigned int i = 0; i < _max_bfactor; ++i) remaining += engine.bernoulli(p);
+            }
+
+            // Selection sampling: each action is chosen with probability (actions still needed) / (actions left)
+            for (unsigned int action = 0; action < _max_bfactor && remaining > 0; ++action) {
+                if (engine.bounded(_max_bfactor - action) < remaining) {
+                    visitor(static_cast<T>(action));
+                    --remaining;
+                }
+            }
+        }
+
+        [[nodiscard]] std::vector<T> actions(std::uint64_t tree_seed, const TreeState<T> &state) const {
+            std::vector<T> output;
+            visit_actions(tree_seed, state, [&output](T action) { output.push_back(action); });
+            return output;
+        }
+
+        [[nodiscard]] unsigned int max_depth() const noexcept { return _max_depth; }
+
+        [[nodiscard]] BranchingDistribution distribution() const noexcept { return _distribution; }
+
+        [[nodiscard]] unsigned int min_bfactor() const noexcept { return _min_bfactor; }
+
+        [[nodiscard]] double avg_bfactor() const noexcept { return _avg_bfactor; }
+
+        [[nodiscard]] unsigned int max_bfactor() const noexcept { return _max_bfactor; }
+
+    private:
+        unsigned int _max_depth;
+        BranchingDistribution _distribution;
+        unsigned int _min_bfactor;
+        double _avg_bfactor;
+        unsigned int _max_bfactor;
+    };
+}
+
+#endif //PARALLEL_BFS_PROJECT_RANDOM_BRANCHING_H
@@ -7,27 +7,108 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <span>
+#include <limits>
+#include <optional>
 #include "../problems_common.h"
+#include "../../problem_utils/binary_format.h"
 
 
 namespace parallel_bfs {
+    /**
+     * @brief State of a tree-like problem, identified by the sequence of actions taken from the root.
+     *
+     * The path is stored as a persistent (shared-suffix) linked list: every state points to the state of its parent,
+     * so creating a child is O(1) and siblings share the whole path of their parent. The hash of the path is computed
+     * incrementally when a child is created and cached, so hashing is also O(1). The full path is only materialised
+     * on demand with path(), which is meant for printing and serialization.
+     *
+     * Trees that number their nodes (e.g. CsrTree) can also store the index of the node of a child when they create it,
+     * so that they find the successors of the child without following its path from the root.
+     */
     template<detail::UnsignedInteger T>
     class TreeState {
     public:
-        TreeState(std::initializer_list<T> init_values = {}) : _vec{init_values} {}
+        TreeState(std::initializer_list<T> init_values = {}) {
+            for (const T action: init_values) append(action);
+        }
+
+        explicit TreeState(const std::vector<T> &init_values) {
+            for (const T action: init_values) append(action);
+        }
+
+        explicit TreeState(const TreeState &prev_state, T new_element) : _tail{prev_state._tail} {
+            append(new_element);
+        }
+
+        /// Child of @prev_state that is node @index of the tree that creates it.
+        explicit TreeState(const TreeState &prev_state, T new_element, std::size_t index) : _tail{prev_state._tail} {
+            append(new_element, index);
+        }
 
-        explicit TreeState(std::vector<T> init_values) : _vec{std::move(init_values)} {}
+        [[nodiscard]] std::size_t depth() const { return _tail ? _tail->depth : 0; }
 
-        explicit TreeState(const TreeState &prev_state, T new_element) : _vec{prev_state._vec} {
-            _vec.push_back(new_element);
+        [[nodiscard]] std::size_t hash() const { return _tail ? _tail->hash : root_hash; }
+
+        /// Index of the node given when the state was created, if any (the root is always node 0). It is only valid in
+        /// the tree that created the state.
+        [[nodiscard]] std::optional<std::size_t> index() const {
+            if (!_tail) return 0;
+            if (_tail->index == no_index) return std::nullopt;
+            return _tail->index;
         }
 
-        [[nodiscard]] std::size_t depth() const { return _vec.size(); }
+        /// Materialises the sequence of actions from the root to this state. Its cost is linear in the depth.
+        [[nodiscard]] std::vector<T> path() const {
+            std::vector<T> output(depth());
+            auto it = output.rbegin();
+            for (const PathNode *node = _tail.get(); node != nullptr; node = node->parent.get()) *it++ = node->action;
+            return output;
+        }
 
-        [[nodiscard]] const std::vector<T> &path() const { return _vec; }
+        /// Calls visitor(action) for each action from the root to this state. Its cost is linear in the depth.
+        template<typename F>
+        void visit_path(F &&visitor) const {
+            for (const T action: path()) visitor(action);
+        }
+
+        friend bool operator==(const TreeState &lhs, const TreeState &rhs) {
+            if (lhs.depth() != rhs.depth() || lhs.hash() != rhs.hash()) return false;
+            // Walk both paths until they reach a shared suffix (at worst, the root)
+            const PathNode *l = lhs._tail.get(), *r = rhs._tail.get();
+            for (; l != r; l = l->parent.get(), r = r->parent.get())
+                if (l->action != r->action) return false;
+            return true;
+        }
 
     private:
-        std::vector<T> _vec;
+        struct PathNode {
+            T action;
+            std::size_t depth;
+            std::size_t hash;
+            std::size_t index;
+            std::shared_ptr<const PathNode> parent;
+        };
+
+        static constexpr std::size_t root_hash = 0;
+        static constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+        /// Incremental version of the vector hashing algorithm from https://stackoverflow.com/a/72073933 (64-bit mixer)
+        [[nodiscard]] static std::size_t combine_hash(std::size_t seed, T action) noexcept {
+            std::uint64_t x = action;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            x = x ^ (x >> 31);
+            return seed ^ (static_cast<std::size_t>(x) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+        }
+
+        void append(T action, std::size_t index = no_index) {
+            _tail = std::make_shared<const PathNode>(PathNode{action, depth() + 1, combine_hash(hash(), action), index, std::move(_tail)});
+        }
+
+        std::shared_ptr<const PathNode> _tail{nullptr}; // nullptr represents the root (empty path)
     };
 
 
@@ -45,32 +126,33 @@ namespace parallel_bfs {
 
 
     template<detail::UnsignedInteger T>
-    bool operator==(const TreeState<T> &lhs, const TreeState<T> &rhs) {
-        if (lhs.depth() != rhs.depth()) return false;
-        return lhs.path() == rhs.path();
-    }
+    bool operator!=(const TreeState<T> &lhs, const TreeState<T> &rhs) { return !(lhs == rhs); }
 
 
+    /// Tree states are encoded as their path from the root.
     template<detail::UnsignedInteger T>
-    bool operator!=(const TreeState<T> &lhs, const TreeState<T> &rhs) { return !(lhs == rhs); }
+    struct BinaryCodec<TreeState<T>> {
+        using value_type = T;
+        static constexpr BinaryTypeTag tag = BinaryTypeTag::TreeState;
+
+        static void encode(const TreeState<T> &state, std::vector<T> &values) {
+            state.visit_path([&values](T action) { values.push_back(action); });
+        }
+
+        [[nodiscard]] static TreeState<T> decode(std::span<const T> values) {
+            TreeState<T> state;
+            for (const T action: values) state = TreeState<T>{state, action};
+            return state;
+        }
+    };
 }
 
 
 
-// TODO: Provide hash specialization for other types besides std::uint32_t
-template<>
-struct std::hash<parallel_bfs::TreeState<std::uint32_t>> {
-    /// Algorithm to compute the hash of a vector taken from https://stackoverflow.com/a/72073933
-    std::size_t operator()(const parallel_bfs::TreeState<std::uint32_t> &s) const noexcept {
-        std::size_t seed = s.depth();
-        for (std::uint32_t x: s.path()) {
-            x = ((x >> 16) ^ x) * 0x45d9f3b;
-            x = ((x >> 16) ^ x) * 0x45d9f3b;
-            x = (x >> 16) ^ x;
-            seed ^= x + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
+template<parallel_bfs::detail::UnsignedInteger T>
+struct std::hash<parallel_bfs::TreeState<T>> {
+    /// The hash is computed incrementally when the state is created, so this is O(1)
+    std::size_t operator()(const parallel_bfs::TreeState<T> &s) const noexcept { return s.hash(); }
 };
 
 
@@ -88,16 +170,17 @@ namespace YAML {
 
         static bool decode(const Node &node, parallel_bfs::TreeState<T> &rhs) {
             if (!node.IsSequence()) return false;
-            std::vector<T> vec = node.as<std::vector<T>>();
-            rhs = parallel_bfs::TreeState<T>{std::move(vec)};
+            rhs = parallel_bfs::TreeState<T>{node.as<std::vector<T>>()};
             return true;
         }
     };
 
 
     template<parallel_bfs::ConvertibleToYAML T>
-    Emitter& operator << (Emitter& out, const parallel_bfs::TreeState<T> state) {
-        out << YAML::Flow << state.path();
+    Emitter& operator << (Emitter& out, const parallel_bfs::TreeState<T> &state) {
+        out << YAML::Flow << YAML::BeginSeq;
+        state.visit_path([&out](T action) { out << action; });
+        out << YAML::EndSeq;
         return out;
     }
 }
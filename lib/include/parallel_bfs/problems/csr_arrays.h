@@ -0,0 +1,72 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_CSR_ARRAYS_H
+#define PARALLEL_BFS_PROJECT_CSR_ARRAYS_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <stdexcept>
+
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief Immutable offsets and edges arrays of a Compressed Sparse Row (CSR) structure.
+     *
+     * The arrays are either owned (built in memory) or borrowed from another object that keeps them alive, such as a
+     * memory-mapped problem file. In both cases the storage is shared between copies, which is safe because it is
+     * never modified, and it makes copying a transition model O(1).
+     */
+    template<typename T>
+    class CsrArrays {
+    public:
+        CsrArrays() : CsrArrays{std::vector<std::size_t>{0}, std::vector<T>{}} {}
+
+        CsrArrays(std::vector<std::size_t> offsets, std::vector<T> edges) {
+            auto storage = std::make_shared<const Storage>(Storage{std::move(offsets), std::move(edges)});
+            _offsets = storage->offsets;
+            _edges = storage->edges;
+            _owner = std::move(storage);
+            validate();
+        }
+
+        /// Views arrays whose memory belongs to @owner. @owner is kept alive for as long as any copy of this object.
+        CsrArrays(std::shared_ptr<const void> owner, std::span<const std::size_t> offsets, std::span<const T> edges)
+                : _owner{std::move(owner)}, _offsets{offsets}, _edges{edges} {
+            validate();
+        }
+
+        [[nodiscard]] std::size_t num_nodes() const noexcept { return _offsets.size() - 1; }
+
+        /// Edges of node @i, i.e. the range [offsets[i], offsets[i+1]) of the edges array.
+        [[nodiscard]] std::span<const T> row(std::size_t i) const noexcept {
+            return _edges.subspan(_offsets[i], _offsets[i + 1] - _offsets[i]);
+        }
+
+        [[nodiscard]] std::span<const std::size_t> offsets() const noexcept { return _offsets; }
+
+        [[nodiscard]] std::span<const T> edges() const noexcept { return _edges; }
+
+    private:
+        struct Storage {
+            std::vector<std::size_t> offsets;
+            std::vector<T> edges;
+        };
+
+        /// Rejects arrays that would make row() read out of bounds. The offsets are scanned once, sequentially.
+        void validate() const {
+            if (_offsets.empty() || _offsets.front() != 0 || _offsets.back() != _edges.size())
+                throw std::invalid_argument("Invalid CSR offsets.");
+            for (std::size_t i = 1; i < _offsets.size(); ++i)
+                if (_offsets[i] < _offsets[i - 1]) throw std::invalid_argument("Invalid CSR offsets.");
+        }
+
+        std::shared_ptr<const void> _owner;
+        std::span<const std::size_t> _offsets;
+        std::span<const T> _edges;
+    };
+}
+
+#endif //PARALLEL_BFS_PROJECT_CSR_ARRAYS_H
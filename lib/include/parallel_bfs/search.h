@@ -6,16 +6,36 @@
 #define PARALLEL_BFS_SEARCH_H
 
 #include "search/search_strategies/any_of_bfs.h"
+#include "search/search_strategies/arena_bfs.h"
 #include "search/search_strategies/async_bfs.h"
 #include "search/search_strategies/async_start_bfs.h"
+#include "search/search_strategies/best_first_search.h"
+#include "search/search_strategies/bidirectional_bfs.h"
 #include "search/search_strategies/foreach_bfs.h"
 #include "search/search_strategies/foreach_start_bfs.h"
+#include "search/search_strategies/hda_star_search.h"
+#include "search/search_strategies/iddfs.h"
+#include "search/search_strategies/level_sync_bfs.h"
 #include "search/search_strategies/multithread_bfs.h"
+#include "search/search_strategies/shared_queue_bfs.h"
 #include "search/search_strategies/sync_bfs.h"
 #include "search/search_strategies/tasks_bfs.h"
+#include "search/search_strategies/work_stealing_bfs.h"
+#include "search/auto_tuner.h"
+#include "search/chase_lev_deque.h"
+#include "search/closed_list.h"
+#include "search/goal_index.h"
+#include "search/mpmc_queue.h"
 #include "search/node.h"
+#include "search/node_arena.h"
+#include "search/placement.h"
+#include "search/priority_queue.h"
 #include "search/problem.h"
+#include "search/search_stats.h"
 #include "search/state.h"
+#include "search/thread_pool.h"
+#include "search/trace.h"
 #include "search/transition_model.h"
+#include "search/workload.h"
 
 #endif //PARALLEL_BFS_SEARCH_H
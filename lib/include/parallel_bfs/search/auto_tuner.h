@@ -0,0 +1,421 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_AUTO_TUNER_H
+#define PARALLEL_BFS_AUTO_TUNER_H
+
+#include <array>
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <thread>
+#include <ranges>
+#include "search_strategies/arena_bfs.h"
+#include "search_strategies/async_start_bfs.h"
+#include "search_strategies/level_sync_bfs.h"
+#include "search_strategies/multithread_bfs.h"
+#include "search_strategies/shared_queue_bfs.h"
+#include "search_strategies/tasks_bfs.h"
+#include "search_strategies/work_stealing_bfs.h"
+#include "node.h"
+#include "placement.h"
+#include "problem.h"
+#include "state.h"
+#include "thread_pool.h"
+#include "transition_model.h"
+
+
+namespace parallel_bfs {
+    /// Search strategies that the AutoTuner chooses from. All of them return a shallowest solution.
+    enum class Strategy {
+        Sequential,   ///< arena_sync_bfs
+        Tasks,        ///< tasks_bfs
+        AsyncStart,   ///< async_start_bfs
+        Multithread,  ///< multithread_bfs
+        ArenaTasks,   ///< arena_tasks_bfs
+        WorkStealing, ///< work_stealing_bfs
+        LevelSync,    ///< level_sync_bfs
+        SharedQueue,  ///< shared_queue_bfs
+    };
+
+    inline constexpr std::array<Strategy, 8> all_strategies = {
+            Strategy::Sequential, Strategy::Tasks, Strategy::AsyncStart, Strategy::Multithread, Strategy::ArenaTasks,
+            Strategy::WorkStealing, Strategy::LevelSync, Strategy::SharedQueue
+    };
+
+    /// Name of the strategy in the benchmark results (e.g. "WorkStealingBFS").
+    [[nodiscard]] constexpr std::string_view strategy_name(Strategy strategy) noexcept {
+        switch (strategy) {
+            case Strategy::Sequential: return "ArenaSyncBFS";
+            case Strategy::Tasks: return "TasksBFS";
+            case Strategy::AsyncStart: return "AsyncStartBFS";
+            case Strategy::Multithread: return "MultithreadBFS";
+            case Strategy::ArenaTasks: return "ArenaTasksBFS";
+            case Strategy::WorkStealing: return "WorkStealingBFS";
+            case Strategy::LevelSync: return "LevelSyncBFS";
+            case Strategy::SharedQueue: return "SharedQueueBFS";
+        }
+        return "";
+    }
+
+    /// Inverse of strategy_name().
+    [[nodiscard]] inline std::optional<Strategy> parse_strategy(std::string_view name) noexcept {
+        for (const Strategy strategy: all_strategies)
+            if (strategy_name(strategy) == name) return strategy;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Default split granularity of each strategy, i.e. the value of its granularity parameter:
+     *  - Tasks, AsyncStart, Multithread and ArenaTasks: starting points per thread.
+     *  - WorkStealing: nodes that each thread publishes for the others to steal.
+     *  - SharedQueue: nodes taken from the queue at once.
+     *  - Sequential and LevelSync have none (0).
+     */
+    [[nodiscard]] constexpr unsigned int default_granularity(Strategy strategy) noexcept {
+        switch (strategy) {
+            case Strategy::Tasks:
+            case Strategy::AsyncStart:
+            case Strategy::Multithread:
+            case Strategy::ArenaTasks:
+            case Strategy::WorkStealing: return 4;
+            case Strategy::SharedQueue: return 32;
+            default: return 0;
+        }
+    }
+
+
+    /// A strategy and its parameters.
+    struct TuningChoice {
+        Strategy strategy{Strategy::Sequential};
+        unsigned int threads{1};     ///< Size of the pool (1 for Sequential)
+        unsigned int granularity{0}; ///< See default_granularity()
+
+        auto operator<=>(const TuningChoice &) const = default;
+    };
+
+    /**
+     * @brief Choices that the exploration runs measure (see AutoTuner::explore) with up to @max_threads threads.
+     *
+     * Every parallel strategy is run with all the threads and with half of them, and with its default granularity,
+     * a quarter of it and twice it, so that the profile also covers choices that the default algorithms never make.
+     */
+    [[nodiscard]] inline std::vector<TuningChoice> tuning_candidates(unsigned int max_threads) {
+        max_threads = std::max(max_threads, 1u);
+        std::vector<unsigned int> thread_counts{max_threads};
+        if (max_threads / 2 > 1) thread_counts.push_back(max_threads / 2);
+
+        std::vector<TuningChoice> candidates{{Strategy::Sequential, 1, default_granularity(Strategy::Sequential)}};
+        for (const Strategy strategy: all_strategies) {
+            if (strategy == Strategy::Sequential) continue;
+            const unsigned int granularity = default_granularity(strategy);
+            std::vector<unsigned int> granularities{granularity};
+            if (granularity > 0) granularities.insert(granularities.end(), {std::max(granularity / 4, 1u), granularity * 2});
+            for (const unsigned int threads: thread_counts)
+                for (const unsigned int g: granularities) candidates.push_back({strategy, threads, g});
+        }
+        return candidates;
+    }
+
+
+    /// E.g. "WorkStealingBFS, threads: 8, granularity: 4".
+    [[nodiscard]] inline std::string to_string(const TuningChoice &choice) {
+        return std::string{strategy_name(choice.strategy)} + ", threads: " + std::to_string(choice.threads) + ", granularity: " + std::to_string(choice.granularity);
+    }
+
+
+    /// What a cheap prefix of a search tells about the rest of it.
+    struct ProblemFeatures {
+        double branching_factor{0.0};           ///< Average number of children of the expanded nodes
+        std::chrono::nanoseconds goal_test{0};  ///< Average time of a goal test (including its workload)
+        std::chrono::nanoseconds expansion{0};  ///< Average time of an expansion
+
+        /**
+         * @brief Coarse description of the problem used to look it up in a TuningProfile, e.g. "b4_g10us".
+         *
+         * The branching factor is rounded to a power of 2 and the goal-test time to a power of 10 (from 100 ns to
+         * 1 ms), so that the measurement noise of the sample rarely changes the key of a problem.
+         */
+        [[nodiscard]] std::string key() const {
+            const double branching = std::max(branching_factor, 1.0);
+            const auto branching_bucket = 1ull << static_cast<unsigned int>(std::lround(std::log2(branching)));
+            const double goal_ns = std::max(static_cast<double>(goal_test.count()), 1.0);
+            constexpr std::array<std::string_view, 5> goal_buckets = {"100ns", "1us", "10us", "100us", "1ms"};
+            const auto goal_bucket = std::clamp<long>(std::lround(std::log10(goal_ns)) - 2, 0, goal_buckets.size() - 1);
+            return "b" + std::to_string(branching_bucket) + "_g" + std::string{goal_buckets[goal_bucket]};
+        }
+    };
+
+
+    /// Features of a problem, and the solution if the sample already found it.
+    template<Searchable State>
+    struct ProblemSample {
+        ProblemFeatures features{};
+        std::shared_ptr<Node<State>> solution{nullptr};
+        bool complete{false}; ///< The sample searched the whole problem, so @solution is the result of the search
+    };
+
+
+    /**
+     * @brief Runs a sequential BFS from the initial state of @problem until it has expanded @max_expansions nodes or
+     * for @budget, whichever comes first, and measures its branching factor and the cost of its goal tests.
+     *
+     * Nodes are goal-tested in the same order as in a BFS, so a solution found by the sample is a shallowest one. It
+     * is a tree-like search: in graphs, the branching factor also counts the repeated states.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    [[nodiscard]] ProblemSample<State> sample_problem(const Problem<State, TM> &problem, std::size_t max_expansions = 64,
+                                                      std::chrono::microseconds budget = std::chrono::microseconds{1000}) {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        ProblemSample<State> sample;
+        std::deque<std::shared_ptr<Node<State>>> frontier{std::make_shared<Node<State>>(problem.initial())};
+        std::size_t goal_tests = 0, expansions = 0, children = 0;
+        clock::duration goal_time{0}, expansion_time{0};
+
+        while (!frontier.empty() && expansions < max_expansions && (expansions == 0 || clock::now() - start < budget)) {
+            auto node = std::move(frontier.front());
+            frontier.pop_front();
+
+            auto before = clock::now();
+            const bool goal = problem.is_goal(node->state());
+            goal_time += clock::now() - before;
+            ++goal_tests;
+            if (goal) {
+                sample.solution = std::move(node);
+                sample.complete = true;
+                break;
+            }
+
+            before = clock::now();
+            problem.expand(node, [&frontier, &children](std::shared_ptr<Node<State>> &&child) {
+                frontier.push_back(std::move(child));
+                ++children;
+            });
+            expansion_time += clock::now() - before;
+            ++expansions;
+        }
+        if (frontier.empty()) sample.complete = true; // Either a solution or no solution at all
+
+        if (expansions > 0) {
+            sample.features.branching_factor = static_cast<double>(children) / static_cast<double>(expansions);
+            sample.features.expansion = std::chrono::duration_cast<std::chrono::nanoseconds>(expansion_time) / expansions;
+        }
+        sample.features.goal_test = std::chrono::duration_cast<std::chrono::nanoseconds>(goal_time) / goal_tests;
+        return sample;
+    }
+
+
+    /**
+     * @brief Running times of the strategies (and their parameters) measured on each kind of problem (see
+     * ProblemFeatures::key).
+     *
+     * Each time is a running average of the last runs: once a choice has been measured @window times, every new run
+     * replaces 1/@window of the average, so that the profile follows changes of the machine or of the implementation.
+     *
+     * The runs of the AutoTuned algorithm are kept apart from the runs of the strategies themselves, so that the
+     * choices are only made from the latter (see best()) and the former tell how well the tuner does.
+     */
+    class TuningProfile {
+    public:
+        struct Entry {
+            unsigned int runs{0};
+            double average_ms{0.0};
+        };
+
+        using Choices = std::map<TuningChoice, Entry>;
+
+        static constexpr unsigned int window = 16;
+
+        void record(const std::string &key, const TuningChoice &choice, double milliseconds, bool auto_tuned = false) {
+            Entry &entry = (auto_tuned ? _auto_tuned : _problems)[key][choice];
+            ++entry.runs;
+            entry.average_ms += (milliseconds - entry.average_ms) / std::min(entry.runs, window);
+        }
+
+        /// Replaces the entry of @choice, e.g. when the profile is read from a file.
+        void set(const std::string &key, const TuningChoice &choice, Entry entry, bool auto_tuned = false) {
+            (auto_tuned ? _auto_tuned : _problems)[key][choice] = entry;
+        }
+
+        /// Fastest choice for the problems of @key among those accepted by @allowed, if any has been measured.
+        template<std::predicate<const TuningChoice &> F>
+        [[nodiscard]] std::optional<TuningChoice> best(const std::string &key, F &&allowed) const {
+            const auto problem = _problems.find(key);
+            if (problem == _problems.end()) return std::nullopt;
+            std::optional<TuningChoice> best;
+            double best_ms = 0.0;
+            for (const auto &[choice, entry]: problem->second) {
+                if (!allowed(choice) || entry.runs == 0) continue;
+                if (!best || entry.average_ms < best_ms) {
+                    best = choice;
+                    best_ms = entry.average_ms;
+                }
+            }
+            return best;
+        }
+
+        /// Runs of the strategies, by kind of problem.
+        [[nodiscard]] const std::map<std::string, Choices> &problems() const noexcept { return _problems; }
+
+        /// Runs of the AutoTuned algorithm, by kind of problem and choice.
+        [[nodiscard]] const std::map<std::string, Choices> &auto_tuned() const noexcept { return _auto_tuned; }
+
+        /// Every kind of problem with runs of the strategies or of the AutoTuned algorithm.
+        [[nodiscard]] std::set<std::string> keys() const {
+            std::set<std::string> keys;
+            for (const auto &[key, choices]: _problems) keys.insert(key);
+            for (const auto &[key, choices]: _auto_tuned) keys.insert(key);
+            return keys;
+        }
+
+    private:
+        std::map<std::string, Choices> _problems{};
+        std::map<std::string, Choices> _auto_tuned{};
+    };
+
+
+    /**
+     * @brief Picks a strategy, a number of threads and a split granularity for each problem, and runs it.
+     *
+     * The problem is first sampled (see sample_problem). If the profile has measurements of problems with the same
+     * features, the fastest choice is used. Otherwise, the choice is estimated from the sample: in narrow trees, threads
+     * only add synchronization, so the search is sequential; with cheap nodes, work stealing has the least contention;
+     * and with expensive goal tests, a shared queue balances the work best, with batches
+     * that hold a few tens of microseconds of work each.
+     *
+     * Parallel strategies run on the pool given to search() if it has the chosen number of threads, or on a pool owned
+     * by the tuner otherwise. The tuner creates its pools when it is constructed (one for each number of threads of
+     * tuning_candidates), so that no search pays for the creation of threads, and it only makes choices that can run
+     * on one of the pools. The profile is not updated by the tuner: see Solver, which updates it from the results,
+     * and which also measures other choices with explore().
+     */
+    class AutoTuner {
+    public:
+        /// @max_threads is the size of the pools that will be given to search(), and the workers of the pools of the
+        /// tuner are placed according to @placement.
+        explicit AutoTuner(std::shared_ptr<const TuningProfile> profile, unsigned int max_threads = std::thread::hardware_concurrency(),
+                           PlacementPolicy placement = PlacementPolicy::Compact) : _profile{std::move(profile)} {
+            max_threads = std::max(max_threads, 1u);
+            for (const TuningChoice &choice: tuning_candidates(max_threads)) {
+                if (choice.strategy == Strategy::Sequential || choice.threads == max_threads || _pools.contains(choice.threads)) continue;
+                _pools.emplace(choice.threads, std::make_unique<ThreadPool>(choice.threads, placement));
+            }
+        }
+
+        /// Choice for the problems with @features, with at most @max_threads threads.
+        [[nodiscard]] TuningChoice choose(const ProblemFeatures &features, unsigned int max_threads) const {
+            max_threads = std::max(max_threads, 1u);
+            if (_profile) {
+                const auto runnable = [this, max_threads](const TuningChoice &choice) { return can_run(choice, max_threads); };
+                if (auto best = _profile->best(features.key(), runnable)) return *best;
+            }
+
+            using namespace std::chrono_literals;
+            const auto node_cost = features.goal_test + features.expansion;
+            if (max_threads == 1 || features.branching_factor < 1.5)
+                return {Strategy::Sequential, 1, default_granularity(Strategy::Sequential)};
+            if (node_cost < 1us) return {Strategy::WorkStealing, max_threads, default_granularity(Strategy::WorkStealing)};
+            const auto batch = std::clamp<long>(20us / node_cost, 1, default_granularity(Strategy::SharedQueue));
+            return {Strategy::SharedQueue, max_threads, static_cast<unsigned int>(batch)};
+        }
+
+        /// Samples @problem, and runs the choice for it with at most pool.size() threads. If the sample already solved
+        /// the problem, its solution is returned.
+        template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+        [[nodiscard]] std::shared_ptr<Node<State>> search(const Problem<State, TM> &problem, ThreadPool &pool) {
+            auto sample = sample_problem(problem);
+            if (!sample.complete) return search<State, TM, Mode>(problem, pool, sample);
+            _last_choice.reset();
+            return sample.solution;
+        }
+
+        /// Same as above, with a @sample of @problem taken beforehand (e.g. once for several searches of it). Since the
+        /// sample is not part of this search, the choice is run even if the sample already solved the problem, so
+        /// that the time of the search is always the time of its choice.
+        template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+        [[nodiscard]] std::shared_ptr<Node<State>> search(const Problem<State, TM> &problem, ThreadPool &pool, const ProblemSample<State> &sample) {
+            _last_choice = choose(sample.features, pool.size());
+            return run<State, TM, Mode>(problem, pool, *_last_choice);
+        }
+
+        /**
+         * @brief Runs the candidate (see tuning_candidates) with the fewest runs in the profile for the problems with
+         * the features of @sample, so that the profile learns about choices that it would not make otherwise.
+         *
+         * Candidates that are tied take turns, so successive explorations of the same problem run different choices.
+         * Like search() with a sample, the candidate is run even if the sample already solved the problem.
+         */
+        template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+        [[nodiscard]] std::shared_ptr<Node<State>> explore(const Problem<State, TM> &problem, ThreadPool &pool, const ProblemSample<State> &sample) {
+            _last_choice = least_measured(sample.features.key(), pool.size());
+            return run<State, TM, Mode>(problem, pool, *_last_choice);
+        }
+
+        /// Choice of the last search. Empty if there has been none, or if the sample of search() solved the problem.
+        [[nodiscard]] const std::optional<TuningChoice> &last_choice() const noexcept { return _last_choice; }
+
+    private:
+        template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode>
+        [[nodiscard]] std::shared_ptr<Node<State>> run(const Problem<State, TM> &problem, ThreadPool &pool, const TuningChoice &choice) {
+            if (choice.strategy == Strategy::Sequential) return arena_sync_bfs<State, TM, Mode>(problem);
+
+            ThreadPool &threads = choice.threads == pool.size() ? pool : *_pools.at(choice.threads);
+            const unsigned int granularity = choice.granularity;
+            switch (choice.strategy) {
+                case Strategy::Sequential: break;
+                case Strategy::Tasks: return tasks_bfs<State, TM, Mode>(problem, threads, granularity);
+                case Strategy::AsyncStart: return async_start_bfs<State, TM, Mode>(problem, threads, granularity);
+                case Strategy::Multithread: return multithread_bfs<State, TM, Mode>(problem, threads, granularity);
+                case Strategy::ArenaTasks: return arena_tasks_bfs<State, TM, Mode>(problem, threads, granularity);
+                case Strategy::WorkStealing: return work_stealing_bfs<State, TM, Mode>(problem, threads, granularity);
+                case Strategy::LevelSync: return level_sync_bfs<State, TM, Mode>(problem, threads);
+                case Strategy::SharedQueue: return shared_queue_bfs<State, TM, Mode>(problem, threads, granularity);
+            }
+            return nullptr;
+        }
+
+        [[nodiscard]] TuningChoice least_measured(const std::string &key, unsigned int max_threads) {
+            const TuningProfile::Choices *measured = nullptr;
+            if (_profile)
+                if (const auto it = _profile->problems().find(key); it != _profile->problems().end()) measured = &it->second;
+            const auto runs = [measured](const TuningChoice &choice) -> unsigned int {
+                if (!measured) return 0;
+                const auto it = measured->find(choice);
+                return it == measured->end() ? 0 : it->second.runs;
+            };
+
+            std::vector<TuningChoice> candidates;
+            std::ranges::copy_if(tuning_candidates(max_threads), std::back_inserter(candidates),
+                                 [this, max_threads](const TuningChoice &c) { return can_run(c, max_threads); });
+            const unsigned int fewest = std::ranges::min(candidates | std::views::transform(runs));
+            std::vector<TuningChoice> least;
+            std::ranges::copy_if(candidates, std::back_inserter(least), [&runs, fewest](const TuningChoice &c) { return runs(c) == fewest; });
+            return least[_explorations++ % least.size()];
+        }
+
+        /// Whether @choice can run on a pool of @max_threads threads given to search(), or on a pool of the tuner.
+        [[nodiscard]] bool can_run(const TuningChoice &choice, unsigned int max_threads) const {
+            if (choice.strategy == Strategy::Sequential) return true;
+            return choice.threads == max_threads || (choice.threads < max_threads && _pools.contains(choice.threads));
+        }
+
+        std::shared_ptr<const TuningProfile> _profile;
+        std::map<unsigned int, std::unique_ptr<ThreadPool>> _pools{};
+        std::optional<TuningChoice> _last_choice{};
+        std::size_t _explorations{0};
+    };
+}
+
+#endif //PARALLEL_BFS_AUTO_TUNER_H
@@ -0,0 +1,123 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_CHASE_LEV_DEQUE_H
+#define PARALLEL_BFS_CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief Lock-free work-stealing deque (Chase and Lev, with the memory orderings of Lê et al., PPoPP 2013).
+     *
+     * The owner thread pushes and pops elements at the bottom, while any other thread may steal elements from the top.
+     * Only steal() and the pop() of the last element synchronize through a CAS, so the owner works without contention
+     * most of the time. The buffer grows when it is full; old buffers are kept until the deque is destroyed, because
+     * a concurrent thief may still be reading from them.
+     */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    class ChaseLevDeque {
+    public:
+        explicit ChaseLevDeque(std::size_t initial_capacity = 256) {
+            std::size_t capacity = 1;
+            while (capacity < initial_capacity) capacity <<= 1;
+            _buffers.push_back(std::make_unique<Buffer>(capacity));
+            _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        ChaseLevDeque(const ChaseLevDeque &) = delete;
+
+        ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+        /// Only the owner may call this method.
+        void push(T value) {
+            const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = _top.load(std::memory_order_acquire);
+            Buffer *buffer = _buffer.load(std::memory_order_relaxed);
+            if (b - t > static_cast<std::int64_t>(buffer->capacity) - 1) buffer = grow(buffer, b, t);
+            buffer->put(b, value);
+            _bottom.store(b + 1, std::memory_order_release); // Publishes the element (and what it points to) to thieves
+        }
+
+        /// Removes the most recently pushed element. Only the owner may call this method.
+        std::optional<T> pop() {
+            const std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+            Buffer *buffer = _buffer.load(std::memory_order_relaxed);
+            _bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = _top.load(std::memory_order_relaxed);
+
+            if (t > b) { // Empty
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            T value = buffer->get(b);
+            if (t == b) { // Last element: race against the thieves
+                const bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                if (!won) return std::nullopt;
+            }
+            return value;
+        }
+
+        /// Removes the oldest element. Any thread may call this method. It may fail spuriously if another thread
+        /// takes the same element concurrently.
+        std::optional<T> steal() {
+            std::int64_t t = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = _bottom.load(std::memory_order_acquire);
+            if (t >= b) return std::nullopt;
+
+            Buffer *buffer = _buffer.load(std::memory_order_acquire);
+            T value = buffer->get(t);
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return std::nullopt;
+            return value;
+        }
+
+        /// Approximate number of elements. It is exact when called by the owner while no thief is active.
+        [[nodiscard]] std::size_t size() const noexcept {
+            const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = _top.load(std::memory_order_relaxed);
+            return b > t ? static_cast<std::size_t>(b - t) : 0;
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    private:
+        struct Buffer {
+            explicit Buffer(std::size_t capacity) : capacity{capacity}, mask{capacity - 1}, data{std::make_unique<std::atomic<T>[]>(capacity)} {}
+
+            [[nodiscard]] T get(std::int64_t i) const noexcept { return data[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed); }
+
+            void put(std::int64_t i, T value) noexcept { data[static_cast<std::size_t>(i) & mask].store(value, std::memory_order_relaxed); }
+
+            const std::size_t capacity;
+            const std::size_t mask;
+            std::unique_ptr<std::atomic<T>[]> data;
+        };
+
+        Buffer *grow(const Buffer *old, std::int64_t bottom, std::int64_t top) {
+            _buffers.push_back(std::make_unique<Buffer>(old->capacity * 2));
+            Buffer *buffer = _buffers.back().get();
+            for (std::int64_t i = top; i < bottom; ++i) buffer->put(i, old->get(i));
+            _buffer.store(buffer, std::memory_order_release);
+            return buffer;
+        }
+
+        alignas(64) std::atomic<std::int64_t> _top{0};
+        alignas(64) std::atomic<std::int64_t> _bottom{0}; // Written only by the owner, kept on its own cache line
+        std::atomic<Buffer *> _buffer{nullptr};
+        std::vector<std::unique_ptr<Buffer>> _buffers{}; // Owned buffers (current and retired). Only the owner grows it.
+    };
+}
+
+#endif //PARALLEL_BFS_CHASE_LEV_DEQUE_H
@@ -0,0 +1,102 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_CLOSED_LIST_H
+#define PARALLEL_BFS_CLOSED_LIST_H
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+#include <type_traits>
+#include <concepts>
+#include <cstdint>
+#include "state.h"
+
+namespace parallel_bfs {
+    /// Tree-like search never checks for repeated states. Graph search keeps a closed list with every generated state,
+    /// so that each state is expanded at most once (needed for problems with cycles, like BasicGraph).
+    enum class SearchMode { Tree, Graph };
+}
+
+
+namespace parallel_bfs::detail {
+    template<typename T, typename State>
+    concept ClosedListFor = requires(T &closed, const State &state) {
+        { closed.insert(state) } -> std::same_as<bool>;
+    };
+
+
+    /// Closed list used by tree-like search. It accepts every state and it is optimized away by the compiler.
+    template<Searchable State>
+    class NoClosedList {
+    public:
+        constexpr bool insert(const State &) noexcept { return true; }
+    };
+
+
+    /// Sequential closed list. Not thread-safe.
+    template<Searchable State>
+    class ClosedList {
+    public:
+        /// Returns true if @state had not been inserted before.
+        bool insert(const State &state) { return _states.insert(state).second; }
+
+        [[nodiscard]] std::size_t size() const { return _states.size(); }
+
+    private:
+        std::unordered_set<State> _states{};
+    };
+
+
+    /**
+     * @brief Thread-safe closed list.
+     *
+     * States are distributed among a fixed number of shards according to their hash, and each shard is protected by
+     * its own mutex. Threads inserting different states rarely contend for the same lock.
+     */
+    template<Searchable State, std::size_t NumShards = 64>
+    class ConcurrentClosedList {
+        static_assert((NumShards & (NumShards - 1)) == 0, "The number of shards must be a power of 2.");
+
+    public:
+        /// Returns true if @state had not been inserted before (by any thread).
+        bool insert(const State &state) {
+            const std::size_t hash = std::hash<State>{}(state);
+            Shard &shard = _shards[shard_index(hash)];
+            std::lock_guard lock{shard.mutex};
+            return shard.states.insert(state).second;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            std::size_t total = 0;
+            for (const Shard &shard: _shards) {
+                std::lock_guard lock{shard.mutex};
+                total += shard.states.size();
+            }
+            return total;
+        }
+
+    private:
+        struct alignas(64) Shard { // Avoid false sharing between the mutexes of different shards
+            mutable std::mutex mutex;
+            std::unordered_set<State> states;
+        };
+
+        /// Uses the high bits of a multiplicative hash, because std::hash is the identity for integers.
+        [[nodiscard]] static std::size_t shard_index(std::size_t hash) noexcept {
+            return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ULL) >> 40) & (NumShards - 1);
+        }
+
+        std::array<Shard, NumShards> _shards{};
+    };
+
+
+    template<Searchable State, SearchMode Mode>
+    using closed_list_t = std::conditional_t<Mode == SearchMode::Graph, ClosedList<State>, NoClosedList<State>>;
+
+    template<Searchable State, SearchMode Mode>
+    using concurrent_closed_list_t = std::conditional_t<Mode == SearchMode::Graph, ConcurrentClosedList<State>, NoClosedList<State>>;
+}
+
+#endif //PARALLEL_BFS_CLOSED_LIST_H
@@ -0,0 +1,215 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_GOAL_INDEX_H
+#define PARALLEL_BFS_GOAL_INDEX_H
+
+#include <vector>
+#include <array>
+#include <span>
+#include <ranges>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <unordered_set>
+#include "state.h"
+#include "workload.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace parallel_bfs::detail {
+    /// States that know their depth in the search tree (e.g. TreeState). Goal indexes use it to reject states early.
+    template<typename S>
+    concept DepthAware = requires(const S &s) {
+        { s.depth() } -> std::convertible_to<std::size_t>;
+    };
+
+
+    /**
+     * @brief Bit i of the result is set if @values[i] is equal to any of @keys. At most 64 values.
+     *
+     * Each key is broadcast and compared with 8 (AVX2) or 4 (SSE2) values at once, so this is faster than hashing
+     * when there are only a few keys. Values that do not fill a whole register are compared one by one.
+     */
+    [[nodiscard]] inline std::uint64_t match_keys(std::span<const std::uint32_t> values, std::span<const std::uint32_t> keys) noexcept {
+        std::uint64_t result = 0;
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (const std::size_t simd_end = values.size() / 8 * 8; i < simd_end; i += 8) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+            __m256i equal = _mm256_setzero_si256();
+            for (const std::uint32_t key: keys)
+                equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(key))));
+            result |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) << i;
+        }
+#elif defined(__SSE2__)
+        for (const std::size_t simd_end = values.size() / 4 * 4; i < simd_end; i += 4) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+            __m128i equal = _mm_setzero_si128();
+            for (const std::uint32_t key: keys)
+                equal = _mm_or_si128(equal, _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(key))));
+            result |= static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(equal))) << i;
+        }
+#endif
+        for (; i < values.size(); ++i) {
+            if (std::ranges::find(keys, values[i]) != keys.end()) result |= std::uint64_t{1} << i;
+        }
+        return result;
+    }
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Immutable set of goal states, optimized for the goal test of a search.
+     *
+     * Goals are stored in a dense vector, and indexed by an open-addressing table (linear probing, load factor of at
+     * most 1/2) whose slots hold a 32-bit fingerprint of the hash of the goal next to its position in the vector. A
+     * probe only compares a state with a goal when their fingerprints match, so misses, which are by far the most
+     * common result of a goal test, never touch the goals themselves. On top of that:
+     *  - States with a depth() (see detail::DepthAware) are rejected without hashing when no goal has their depth.
+     *  - The table is fronted by a blocked Bloom filter (16 bits per goal) that answers most misses with a single
+     *    64-bit word and a branch that is almost always taken, which is cheaper than probing even a small table.
+     *
+     * States can also be tested in batches (see match()). Batches of 32-bit integer states are compared with SIMD
+     * instructions when there are only a few goals, which is the usual case of graph problems.
+     *
+     * The index is never modified after construction, so any number of threads can query it without synchronization.
+     */
+    template<Searchable State>
+    class GoalIndex {
+    public:
+        /// Maximum number of states tested by each call to match().
+        static constexpr std::size_t batch_size = 64;
+
+        GoalIndex() : GoalIndex{std::unordered_set<State>{}} {}
+
+        explicit GoalIndex(std::unordered_set<State> &&goals) {
+            if (goals.size() >= empty_slot) throw std::length_error("Too many goal states.");
+            _goals.reserve(goals.size());
+            for (auto it = goals.begin(); it != goals.end();) _goals.push_back(std::move(goals.extract(it++).value()));
+
+            const std::size_t capacity = std::bit_ceil(std::max<std::size_t>(2, 2 * _goals.size()));
+            _slots.assign(capacity, Slot{0, empty_slot});
+            _mask = capacity - 1;
+            const std::size_t words = std::bit_ceil(std::max<std::size_t>(2, _goals.size() * filter_bits_per_goal / 64));
+            _filter.assign(words, 0);
+            _filter_shift = 64 - std::countr_zero(words);
+
+            for (std::uint32_t i = 0; i < _goals.size(); ++i) {
+                const std::uint64_t h = hash(_goals[i]);
+                std::size_t pos = h & _mask;
+                while (_slots[pos].index != empty_slot) pos = (pos + 1) & _mask;
+                _slots[pos] = Slot{static_cast<std::uint32_t>(h >> 32), i};
+                _filter[filter_word(h)] |= filter_mask(h);
+                if constexpr (detail::DepthAware<State>) add_depth(_goals[i].depth());
+            }
+        }
+
+        [[nodiscard]] bool contains(const State &state) const {
+            if constexpr (detail::DepthAware<State>) {
+                if (!has_depth(state.depth())) return false;
+            }
+            const std::uint64_t h = hash(state);
+            return filter_contains(h) && table_contains(h, state);
+        }
+
+        /**
+         * @brief Tests the states of the first (up to) batch_size elements of @items at once.
+         *
+         * @param items Random access range of states, or of elements that contain a state (e.g. pointers to nodes).
+         * @param proj Projection that returns a reference to the state of an element of @items.
+         * @return A mask whose bit i is set if the state of @items[i] is a goal.
+         */
+        template<std::ranges::random_access_range R, typename Proj = std::identity>
+        requires std::convertible_to<std::invoke_result_t<Proj &, std::ranges::range_reference_t<R>>, const State &>
+        [[nodiscard]] std::uint64_t match(R &&items, Proj proj = {}) const {
+            const std::size_t count = std::min<std::size_t>(std::ranges::size(items), batch_size);
+            auto state_at = [&items, &proj](std::size_t i) -> const State & { return std::invoke(proj, std::ranges::begin(items)[i]); };
+
+            if constexpr (std::same_as<State, std::uint32_t>) {
+                if (_goals.size() <= simd_max_goals) {
+                    std::array<std::uint32_t, batch_size> values;
+                    for (std::size_t i = 0; i < count; ++i) values[i] = state_at(i);
+                    return detail::match_keys(std::span{values.data(), count}, _goals);
+                }
+            }
+
+            std::uint64_t result = 0;
+            for (std::size_t i = 0; i < count; ++i) result |= static_cast<std::uint64_t>(contains(state_at(i))) << i;
+            return result;
+        }
+
+        /// The goal states, in no particular order.
+        [[nodiscard]] const std::vector<State> &states() const noexcept { return _goals; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _goals.size(); }
+
+        [[nodiscard]] bool empty() const noexcept { return _goals.empty(); }
+
+        [[nodiscard]] auto begin() const noexcept { return _goals.begin(); }
+
+        [[nodiscard]] auto end() const noexcept { return _goals.end(); }
+
+    private:
+        struct Slot {
+            std::uint32_t fingerprint;
+            std::uint32_t index; // Position of the goal in _goals, or empty_slot
+        };
+
+        static constexpr std::uint32_t empty_slot = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::size_t filter_bits_per_goal = 16;
+        static constexpr std::size_t simd_max_goals = 16; // Integer batches are compared with SIMD up to this many goals
+
+        /// std::hash is the identity for integers, so the hash is mixed before its bits are split among the structures.
+        [[nodiscard]] static std::uint64_t hash(const State &state) noexcept { return detail::mix64(std::hash<State>{}(state)); }
+
+        [[nodiscard]] std::size_t filter_word(std::uint64_t h) const noexcept {
+            return (h * 0x9e3779b97f4a7c15ULL) >> _filter_shift;
+        }
+
+        /// Three bits of the same word, so that a query reads a single word. Taken from the bits of the table position.
+        [[nodiscard]] static std::uint64_t filter_mask(std::uint64_t h) noexcept {
+            return (1ULL << (h & 63)) | (1ULL << ((h >> 6) & 63)) | (1ULL << ((h >> 12) & 63));
+        }
+
+        [[nodiscard]] bool filter_contains(std::uint64_t h) const noexcept {
+            return (_filter[filter_word(h)] & filter_mask(h)) == filter_mask(h);
+        }
+
+        [[nodiscard]] bool table_contains(std::uint64_t h, const State &state) const {
+            const auto fingerprint = static_cast<std::uint32_t>(h >> 32);
+            for (std::size_t pos = h & _mask;; pos = (pos + 1) & _mask) {
+                const Slot slot = _slots[pos];
+                if (slot.index == empty_slot) return false;
+                if (slot.fingerprint == fingerprint && _goals[slot.index] == state) return true;
+            }
+        }
+
+        void add_depth(std::size_t depth) {
+            if (depth / 64 >= _depths.size()) _depths.resize(depth / 64 + 1, 0);
+            _depths[depth / 64] |= 1ULL << (depth % 64);
+        }
+
+        [[nodiscard]] bool has_depth(std::size_t depth) const noexcept {
+            return depth / 64 < _depths.size() && (_depths[depth / 64] >> (depth % 64) & 1) != 0;
+        }
+
+        std::vector<State> _goals{};
+        std::vector<Slot> _slots{};
+        std::size_t _mask{0};
+        std::vector<std::uint64_t> _filter{};
+        int _filter_shift{63};
+        std::vector<std::uint64_t> _depths{}; // Bitset of the depths of the goals (only used for DepthAware states)
+    };
+}
+
+#endif //PARALLEL_BFS_GOAL_INDEX_H
@@ -0,0 +1,175 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_MPMC_QUEUE_H
+#define PARALLEL_BFS_MPMC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <span>
+#include <bit>
+#include <algorithm>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+
+namespace parallel_bfs::detail {
+    /// FIFO queue that any number of threads can use at the same time, moving several elements per call.
+    template<typename Q, typename T>
+    concept BulkQueue = requires(Q &queue, std::span<const T> in, std::span<T> out) {
+        { queue.push_bulk(in) } -> std::same_as<std::size_t>;
+        { queue.pop_bulk(out) } -> std::same_as<std::size_t>;
+    };
+
+
+    /**
+     * @brief Bounded lock-free multi-producer multi-consumer FIFO queue (Vyukov's array-based queue).
+     *
+     * Each cell of the ring has a sequence number that tells whether it is ready to be written or read in the current
+     * lap, so producers and consumers only contend on their own position counter, never on each other. Bulk operations
+     * check that a run of consecutive cells is ready and then claim all of it with a single CAS, so the cost of the
+     * contended cache line is paid once per batch instead of once per element.
+     */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    class MpmcQueue {
+    public:
+        /// The capacity is rounded up to a power of two.
+        explicit MpmcQueue(std::size_t capacity = 1 << 16)
+                : _capacity{std::bit_ceil(std::max<std::size_t>(capacity, 2))}, _mask{_capacity - 1}, _cells{std::make_unique<Cell[]>(_capacity)} {
+            for (std::size_t i = 0; i < _capacity; ++i) _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpmcQueue(const MpmcQueue &) = delete;
+
+        MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+        /// Returns false if the queue is full.
+        bool push(T value) { return push_bulk(std::span<const T>{&value, 1}) == 1; }
+
+        /// Removes the oldest element, if any.
+        std::optional<T> pop() {
+            T value;
+            if (pop_bulk(std::span<T>{&value, 1}) == 0) return std::nullopt;
+            return value;
+        }
+
+        /// Appends a prefix of @values, as long as there is room for it. Returns the number of elements appended.
+        std::size_t push_bulk(std::span<const T> values) {
+            if (values.empty()) return 0;
+            std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                const std::size_t count = ready_cells(pos, values.size(), 0);
+                if (count == 0) {
+                    const std::size_t current = _enqueue_pos.load(std::memory_order_relaxed);
+                    if (current == pos) return 0; // Full: the oldest cell has not been read since the last lap
+                    pos = current;
+                    continue;
+                }
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        Cell &cell = _cells[(pos + i) & _mask];
+                        cell.value = values[i];
+                        cell.sequence.store(pos + i + 1, std::memory_order_release); // Publishes the value to consumers
+                    }
+                    return count;
+                }
+            }
+        }
+
+        /// Moves up to @out.size() of the oldest elements to @out. Returns the number of elements moved.
+        std::size_t pop_bulk(std::span<T> out) {
+            if (out.empty()) return 0;
+            std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                const std::size_t count = ready_cells(pos, out.size(), 1);
+                if (count == 0) {
+                    const std::size_t current = _dequeue_pos.load(std::memory_order_relaxed);
+                    if (current == pos) return 0; // Empty, or the next element is still being written
+                    pos = current;
+                    continue;
+                }
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        Cell &cell = _cells[(pos + i) & _mask];
+                        out[i] = cell.value;
+                        cell.sequence.store(pos + i + _capacity, std::memory_order_release); // Free for the next lap
+                    }
+                    return count;
+                }
+            }
+        }
+
+        /// Approximate number of elements.
+        [[nodiscard]] std::size_t size() const noexcept {
+            const std::size_t tail = _enqueue_pos.load(std::memory_order_relaxed);
+            const std::size_t head = _dequeue_pos.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return _capacity; }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        /**
+         * @brief Length of the run of (up to @max) cells from @pos that are ready for the same operation.
+         *
+         * A cell at position p is ready to be written when its sequence is p, and ready to be read when it is p + 1
+         * (@offset). A ready cell cannot change until the thread that claims its position uses it, so the run is still
+         * ready if the CAS on the position counter succeeds afterwards.
+         */
+        [[nodiscard]] std::size_t ready_cells(std::size_t pos, std::size_t max, std::size_t offset) const noexcept {
+            std::size_t count = 0;
+            while (count < max && _cells[(pos + count) & _mask].sequence.load(std::memory_order_acquire) == pos + count + offset) ++count;
+            return count;
+        }
+
+        const std::size_t _capacity;
+        const std::size_t _mask;
+        const std::unique_ptr<Cell[]> _cells;
+        alignas(64) std::atomic<std::size_t> _enqueue_pos{0};
+        alignas(64) std::atomic<std::size_t> _dequeue_pos{0}; // On its own cache line, so producers do not slow consumers
+    };
+
+
+    /// Unbounded FIFO queue protected by a mutex, with the same interface as MpmcQueue. Used as a baseline.
+    template<typename T>
+    class LockedQueue {
+    public:
+        std::size_t push_bulk(std::span<const T> values) {
+            std::lock_guard lock{_mutex};
+            _queue.insert(_queue.end(), values.begin(), values.end());
+            return values.size();
+        }
+
+        std::size_t pop_bulk(std::span<T> out) {
+            std::lock_guard lock{_mutex};
+            const std::size_t count = std::min(out.size(), _queue.size());
+            std::copy_n(_queue.begin(), count, out.begin());
+            _queue.erase(_queue.begin(), _queue.begin() + static_cast<std::ptrdiff_t>(count));
+            return count;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            std::lock_guard lock{_mutex};
+            return _queue.size();
+        }
+
+        [[nodiscard]] bool empty() const { return size() == 0; }
+
+    private:
+        mutable std::mutex _mutex;
+        std::deque<T> _queue{};
+    };
+}
+
+#endif //PARALLEL_BFS_MPMC_QUEUE_H
@@ -15,7 +15,7 @@ namespace parallel_bfs {
         explicit Node(State state, std::shared_ptr<Node<State>> parent = nullptr, int path_cost = 0)
                 : _state{std::move(state)}, _parent{std::move(parent)}, _path_cost{path_cost} {}
 
-        [[nodiscard]] State state() const { return _state; }
+        [[nodiscard]] const State &state() const { return _state; }
 
         [[nodiscard]] std::shared_ptr<Node<State>> parent() const { return _parent; }
 
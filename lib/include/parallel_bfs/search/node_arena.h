@@ -0,0 +1,98 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_NODE_ARENA_H
+#define PARALLEL_BFS_NODE_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include "node.h"
+#include "state.h"
+
+namespace parallel_bfs {
+    /// Search node whose lifetime is managed by a NodeArena instead of reference counting. Parents are plain pointers
+    /// into the same (or another still alive) arena, so copying a node handle never touches an atomic counter.
+    template<Searchable State>
+    class ArenaNode {
+    public:
+        explicit ArenaNode(State state, const ArenaNode *parent = nullptr, int path_cost = 0)
+                : _state{std::move(state)}, _parent{parent}, _path_cost{path_cost} {}
+
+        [[nodiscard]] const State &state() const { return _state; }
+
+        [[nodiscard]] const ArenaNode *parent() const { return _parent; }
+
+        [[nodiscard]] int path_cost() const { return _path_cost; }
+
+    private:
+        const State _state;
+        const ArenaNode *const _parent;
+        const int _path_cost;
+    };
+
+
+    /**
+     * @brief Bump allocator for search nodes.
+     *
+     * Nodes are constructed in place inside fixed-capacity blocks, so their addresses remain stable until the arena is
+     * destroyed or cleared, at which point all of them are released in bulk. An arena is NOT thread-safe: parallel
+     * strategies should give each thread its own arena and keep all of them alive until the search has finished.
+     * Blocks are only allocated (and first written) by make_node(), so the arena of a pinned thread lives in the
+     * memory of its NUMA node, wherever the arena object itself was constructed.
+     */
+    template<Searchable State>
+    class NodeArena {
+    public:
+        explicit NodeArena(std::size_t block_size = 4096) : _block_size{block_size > 0 ? block_size : 1} {}
+
+        NodeArena(const NodeArena &) = delete;
+
+        NodeArena &operator=(const NodeArena &) = delete;
+
+        NodeArena(NodeArena &&) noexcept = default;
+
+        NodeArena &operator=(NodeArena &&) noexcept = default;
+
+        template<typename... Args>
+        [[nodiscard]] const ArenaNode<State> *make_node(Args &&... args) {
+            if (_blocks.empty() || _blocks.back().size() == _block_size) {
+                _blocks.emplace_back();
+                _blocks.back().reserve(_block_size); // Never exceeded, so the block is never reallocated
+            }
+            return &_blocks.back().emplace_back(std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return _blocks.empty() ? 0 : (_blocks.size() - 1) * _block_size + _blocks.back().size();
+        }
+
+        /// Releases all the nodes at once. Any pointer previously returned by make_node() becomes dangling.
+        void clear() { _blocks.clear(); }
+
+    private:
+        std::size_t _block_size;
+        std::vector<std::vector<ArenaNode<State>>> _blocks{};
+    };
+}
+
+
+namespace parallel_bfs::detail {
+    /// Copies the path that ends in @node into a chain of reference counted nodes, so that the solution outlives the
+    /// arena(s) used during the search. The cost is linear in the depth of the solution.
+    template<Searchable State>
+    [[nodiscard]] std::shared_ptr<Node<State>> to_shared_node(const ArenaNode<State> *node) {
+        if (node == nullptr) return nullptr;
+
+        std::vector<const ArenaNode<State> *> path;
+        for (; node != nullptr; node = node->parent()) path.push_back(node);
+
+        std::shared_ptr<Node<State>> shared{nullptr};
+        for (auto it = path.crbegin(); it != path.crend(); ++it)
+            shared = std::make_shared<Node<State>>((*it)->state(), std::move(shared), (*it)->path_cost());
+        return shared;
+    }
+}
+
+#endif //PARALLEL_BFS_NODE_ARENA_H
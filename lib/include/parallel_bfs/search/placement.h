@@ -0,0 +1,138 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PLACEMENT_H
+#define PARALLEL_BFS_PLACEMENT_H
+
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <algorithm>
+#include <system_error>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifdef PARALLEL_BFS_USE_LIBNUMA
+#include <numa.h>
+#endif
+
+
+namespace parallel_bfs {
+    /// Where the workers of a ThreadPool run.
+    enum class PlacementPolicy {
+        None,    ///< Not pinned: the scheduler may move the workers between CPUs (and sockets) at any time.
+        Compact, ///< Pinned, filling all the CPUs of a NUMA node before moving to the next one.
+        Spread,  ///< Pinned, distributed round-robin among the NUMA nodes (more memory bandwidth, more remote traffic).
+    };
+}
+
+
+namespace parallel_bfs::detail {
+    /// CPU and NUMA node assigned to a worker. A negative CPU means that the worker is not pinned.
+    struct CpuSlot {
+        int cpu;
+        unsigned int node;
+    };
+
+
+    /// The CPUs that the process is allowed to run on, grouped by NUMA node. Nodes are numbered from 0 in the order of
+    /// their lowest CPU, and nodes without allowed CPUs are left out, so a machine without NUMA has a single node.
+    class CpuTopology {
+    public:
+        /// Uses libnuma if the library was built with PARALLEL_BFS_USE_LIBNUMA, and Linux's sysfs otherwise.
+        [[nodiscard]] static CpuTopology detect() {
+            CpuTopology topology;
+            std::vector<std::pair<int, int>> cpus; // (OS node, CPU)
+#ifdef __linux__
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                    if (CPU_ISSET(cpu, &allowed)) cpus.emplace_back(os_node_of(cpu), cpu);
+            }
+#endif
+            if (cpus.empty()) { // Unknown topology: a single node, and workers are not pinned
+                topology._node_cpus.emplace_back();
+                return topology;
+            }
+
+            std::ranges::stable_sort(cpus, {}, &std::pair<int, int>::first);
+            for (std::size_t i = 0; i < cpus.size(); ++i) {
+                if (i == 0 || cpus[i].first != cpus[i - 1].first) topology._node_cpus.emplace_back();
+                topology._node_cpus.back().push_back(cpus[i].second);
+            }
+            std::ranges::sort(topology._node_cpus, {}, [](const std::vector<int> &node) { return node.front(); });
+            return topology;
+        }
+
+        [[nodiscard]] unsigned int num_nodes() const noexcept { return static_cast<unsigned int>(_node_cpus.size()); }
+
+        [[nodiscard]] const std::vector<int> &cpus(unsigned int node) const { return _node_cpus[node]; }
+
+        /// CPU and node of each of @num_workers workers. Workers are pinned only if the policy asks for it and the
+        /// topology is known; if there are more workers than CPUs, CPUs are reused in the same order.
+        [[nodiscard]] std::vector<CpuSlot> place(unsigned int num_workers, PlacementPolicy policy) const {
+            std::vector<CpuSlot> slots;
+            std::vector<CpuSlot> order; // Order in which the CPUs are handed out
+            if (policy == PlacementPolicy::Compact) {
+                for (unsigned int node = 0; node < num_nodes(); ++node)
+                    for (const int cpu: _node_cpus[node]) order.push_back(CpuSlot{cpu, node});
+            } else if (policy == PlacementPolicy::Spread) {
+                const std::size_t widest = std::ranges::max(_node_cpus, {}, &std::vector<int>::size).size();
+                for (std::size_t i = 0; i < widest; ++i)
+                    for (unsigned int node = 0; node < num_nodes(); ++node)
+                        if (i < _node_cpus[node].size()) order.push_back(CpuSlot{_node_cpus[node][i], node});
+            }
+
+            for (unsigned int i = 0; i < num_workers; ++i)
+                slots.push_back(order.empty() ? CpuSlot{-1, 0} : order[i % order.size()]);
+            return slots;
+        }
+
+    private:
+        /// NUMA node of @cpu as numbered by the OS, or 0 if it is unknown.
+        [[nodiscard]] static int os_node_of([[maybe_unused]] int cpu) {
+#ifdef PARALLEL_BFS_USE_LIBNUMA
+            if (numa_available() >= 0) return std::max(numa_node_of_cpu(cpu), 0);
+#endif
+            // Each CPU directory contains a link named after its node (e.g. /sys/devices/system/cpu/cpu3/node1)
+            std::error_code error;
+            const std::filesystem::path dir{"/sys/devices/system/cpu/cpu" + std::to_string(cpu)};
+            for (std::filesystem::directory_iterator it{dir, error}, end; !error && it != end; it.increment(error)) {
+                const std::string name = it->path().filename().string();
+                if (name.size() > 4 && name.starts_with("node") && std::ranges::all_of(name.substr(4), [](char c) { return c >= '0' && c <= '9'; }))
+                    return std::stoi(name.substr(4));
+            }
+            return 0;
+        }
+
+        std::vector<std::vector<int>> _node_cpus{};
+    };
+
+
+    /// Pins the calling thread to @cpu. With libnuma, it also asks for its memory to be allocated in its node (which
+    /// is already the default policy of Linux: pages are placed in the node of the thread that first touches them).
+    inline bool pin_current_thread([[maybe_unused]] int cpu) noexcept {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) return false;
+#ifdef PARALLEL_BFS_USE_LIBNUMA
+        if (numa_available() >= 0) numa_set_localalloc();
+#endif
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    /// NUMA node of the calling thread, if it is a worker of a ThreadPool. Always 0 for other threads.
+    inline thread_local unsigned int current_numa_node = 0;
+}
+
+#endif //PARALLEL_BFS_PLACEMENT_H
@@ -0,0 +1,140 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PRIORITY_QUEUE_H
+#define PARALLEL_BFS_PRIORITY_QUEUE_H
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief Implicit d-ary min-heap.
+     *
+     * top() is an element for which no other element compares less according to @Compare. A higher arity than the
+     * binary heap makes the tree shallower, which reduces the number of cache misses of push() at the cost of a few
+     * more comparisons in pop().
+     */
+    template<typename T, typename Compare = std::less<T>, unsigned int D = 4>
+    class DaryHeap {
+        static_assert(D >= 2, "The arity of the heap must be at least 2.");
+
+    public:
+        explicit DaryHeap(Compare compare = Compare{}) : _compare{std::move(compare)} {}
+
+        [[nodiscard]] bool empty() const noexcept { return _data.empty(); }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _data.size(); }
+
+        [[nodiscard]] const T &top() const { return _data.front(); }
+
+        void push(T value) {
+            _data.push_back(std::move(value));
+            sift_up(_data.size() - 1);
+        }
+
+        /// Removes and returns the top element. The heap must not be empty.
+        T pop() {
+            T output = std::move(_data.front());
+            _data.front() = std::move(_data.back());
+            _data.pop_back();
+            if (!_data.empty()) sift_down(0);
+            return output;
+        }
+
+        void clear() noexcept { _data.clear(); }
+
+    private:
+        void sift_up(std::size_t i) {
+            T value = std::move(_data[i]);
+            while (i > 0) {
+                std::size_t parent = (i - 1) / D;
+                if (!_compare(value, _data[parent])) break;
+                _data[i] = std::move(_data[parent]);
+                i = parent;
+            }
+            _data[i] = std::move(value);
+        }
+
+        void sift_down(std::size_t i) {
+            T value = std::move(_data[i]);
+            const std::size_t n = _data.size();
+            while (true) {
+                std::size_t first_child = i * D + 1;
+                if (first_child >= n) break;
+                std::size_t best = first_child;
+                const std::size_t last_child = std::min(first_child + D, n);
+                for (std::size_t c = first_child + 1; c < last_child; ++c)
+                    if (_compare(_data[c], _data[best])) best = c;
+                if (!_compare(_data[best], value)) break;
+                _data[i] = std::move(_data[best]);
+                i = best;
+            }
+            _data[i] = std::move(value);
+        }
+
+        std::vector<T> _data{};
+        Compare _compare;
+    };
+
+
+    /**
+     * @brief Monotone-friendly priority queue for small non-negative integer priorities.
+     *
+     * Elements are stored in one bucket per priority, so push() and pop() are O(1) amortized when priorities are
+     * bounded, as it happens with integer path costs. Elements with the same priority are popped in LIFO order.
+     */
+    template<typename T>
+    class BucketQueue {
+    public:
+        [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+        /// Priority of the element that will be returned by the next call to pop(). The queue must not be empty.
+        [[nodiscard]] int top_priority() {
+            advance_cursor();
+            return static_cast<int>(_cursor);
+        }
+
+        void push(int priority, T value) {
+            if (priority < 0) throw std::invalid_argument("BucketQueue priorities must be non-negative.");
+            const auto p = static_cast<std::size_t>(priority);
+            if (p >= _buckets.size()) _buckets.resize(p + 1);
+            _buckets[p].push_back(std::move(value));
+            if (p < _cursor) _cursor = p;
+            ++_size;
+        }
+
+        /// Removes and returns an element with the lowest priority. The queue must not be empty.
+        T pop() {
+            advance_cursor();
+            auto &bucket = _buckets[_cursor];
+            T output = std::move(bucket.back());
+            bucket.pop_back();
+            --_size;
+            return output;
+        }
+
+        void clear() noexcept {
+            _buckets.clear();
+            _cursor = 0;
+            _size = 0;
+        }
+
+    private:
+        void advance_cursor() {
+            while (_buckets[_cursor].empty()) ++_cursor;
+        }
+
+        std::vector<std::vector<T>> _buckets{};
+        std::size_t _cursor{0};
+        std::size_t _size{0};
+    };
+}
+
+#endif //PARALLEL_BFS_PRIORITY_QUEUE_H
@@ -8,47 +8,124 @@
 #include <vector>
 #include <memory>
 #include <unordered_set>
-#include <thread>
 #include <chrono>
+#include <ranges>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <stop_token>
 #include "node.h"
+#include "node_arena.h"
+#include "goal_index.h"
+#include "search_stats.h"
 #include "transition_model.h"
+#include "workload.h"
 
 namespace parallel_bfs {
     template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
     class Problem {
     public:
         explicit Problem(State initial, std::unordered_set<State> &&goal_states, TM &&tm)
-            : _initial{std::move(initial)}, _goal_states{std::move(goal_states)}, _transition_model{std::move(tm)} {}
+            : _initial{std::move(initial)}, _goals{std::move(goal_states)}, _transition_model{std::move(tm)} {}
 
         [[nodiscard]] State initial() const { return _initial; }
 
         [[nodiscard]] bool is_goal(const State &state) const {
-            auto start = std::chrono::high_resolution_clock::now();
-            while (std::chrono::high_resolution_clock::now() - start < _workload_delay); // busy wait
-            return _goal_states.contains(state);
+            detail::count_goal_tests(1);
+            if (_workload) _workload->run(std::hash<State>{}(state)); // Simulated cost of the goal test
+            return _goals.contains(state);
         }
 
-        [[nodiscard]] std::unordered_set<State> goal_states() const { return _goal_states; }
+        /// Number of states goal-tested by each call to goal_mask().
+        static constexpr std::size_t goal_batch_size = GoalIndex<State>::batch_size;
+
+        /**
+         * @brief Goal-tests the states of the first (up to) goal_batch_size elements of @items at once.
+         *
+         * Equivalent to calling is_goal() for each of them, but it lets the goal index compare the whole batch at once
+         * (see GoalIndex::match). With a workload, the states are tested one by one instead, like is_goal() does, and
+         * the test stops at the first goal or as soon as @stop is requested, so that no workload is charged for the
+         * states after them.
+         * @param proj Projection that returns a reference to the state of an element of @items (e.g. of a node).
+         * @return A mask whose bit i is set if the state of @items[i] is a goal. With a workload, only the first goal
+         * is set, and the states that were not tested because of @stop are not goals.
+         */
+        template<std::ranges::random_access_range R, typename Proj = std::identity>
+        [[nodiscard]] std::uint64_t goal_mask(R &&items, Proj proj = {}, std::stop_token stop = {}) const {
+            const std::size_t count = std::min<std::size_t>(std::ranges::size(items), goal_batch_size);
+            if (!_workload) {
+                detail::count_goal_tests(count);
+                return _goals.match(std::forward<R>(items), std::move(proj));
+            }
+
+            for (std::size_t i = 0; i < count && !stop.stop_requested(); ++i) {
+                if (is_goal(std::invoke(proj, std::ranges::begin(items)[i]))) return std::uint64_t{1} << i;
+            }
+            return 0;
+        }
+
+        [[nodiscard]] const std::vector<State> &goal_states() const { return _goals.states(); }
+
+        [[nodiscard]] const GoalIndex<State> &goal_index() const { return _goals; }
 
         // TODO: perhaps change this to a coroutine when std::generator (C++23) is implemented in gcc/clang
         [[nodiscard]] std::vector<std::shared_ptr<Node<State>>> expand(const std::shared_ptr<Node<State>> &node) const {
+            detail::count_expansion();
             std::vector<std::shared_ptr<Node<State>>> expanded_nodes;
             for (auto &[new_state, cost]: _transition_model.next_states(node->state())) {
-                auto new_node = std::make_shared<Node<State>>(std::move(new_state), node, cost);
+                auto new_node = std::make_shared<Node<State>>(std::move(new_state), node, node->path_cost() + cost);
                 expanded_nodes.push_back(new_node);
             }
             return expanded_nodes;
         }
 
+        /// Expands @node and hands each of its children to @visitor, without building an intermediate vector.
+        template<std::invocable<std::shared_ptr<Node<State>>> F>
+        void expand(const std::shared_ptr<Node<State>> &node, F &&visitor) const {
+            detail::count_expansion();
+            for_each_successor(node->state(), [&node, &visitor](State &&new_state, int cost) {
+                visitor(std::make_shared<Node<State>>(std::move(new_state), node, node->path_cost() + cost));
+            });
+        }
+
+        /// Expands @node allocating its children in @arena, and hands each of them to @visitor.
+        template<std::invocable<const ArenaNode<State> *> F>
+        void expand(const ArenaNode<State> *node, NodeArena<State> &arena, F &&visitor) const {
+            detail::count_expansion();
+            for_each_successor(node->state(), [node, &arena, &visitor](State &&new_state, int cost) {
+                visitor(arena.make_node(std::move(new_state), node, node->path_cost() + cost));
+            });
+        }
+
+        /// Invokes visitor(State &&next, int cost) for each successor of @state. Models that implement the
+        /// SuccessorGenerator API are called without virtual dispatch nor heap allocations; the rest fall back to
+        /// the virtual next_states().
+        template<std::invocable<State &&, int> F>
+        void for_each_successor(const State &state, F &&visitor) const {
+            if constexpr (StaticSuccessorGenerator<TM, State>) {
+                _transition_model.for_each_successor(state, std::forward<F>(visitor));
+            } else {
+                for (auto &[new_state, cost]: _transition_model.next_states(state)) visitor(std::move(new_state), cost);
+            }
+        }
+
         [[nodiscard]] const TM &transition_model() const { return _transition_model; }
 
-        void set_workload_delay(std::chrono::microseconds us) {_workload_delay = us; }
+        /// Every goal test runs @workload first. A null workload makes goal tests as cheap as possible.
+        void set_workload(std::shared_ptr<const WorkloadModel> workload) { _workload = std::move(workload); }
+
+        [[nodiscard]] const std::shared_ptr<const WorkloadModel> &workload() const { return _workload; }
+
+        /// Shorthand for a SpinWorkload of @us microseconds.
+        void set_workload_delay(std::chrono::microseconds us) {
+            set_workload(us.count() > 0 ? std::make_shared<const SpinWorkload>(us) : nullptr);
+        }
 
     private:
         State _initial;
-        std::unordered_set<State> _goal_states;
+        GoalIndex<State> _goals;
         TM _transition_model;
-        std::chrono::microseconds _workload_delay{0};
+        std::shared_ptr<const WorkloadModel> _workload{nullptr};
     };
 
 
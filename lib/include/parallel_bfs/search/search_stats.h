@@ -0,0 +1,271 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_SEARCH_STATS_H
+#define PARALLEL_BFS_SEARCH_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <algorithm>
+#include "trace.h"
+
+/// Search statistics are only collected if PARALLEL_BFS_ENABLE_STATS is defined to a non-zero value (see the
+/// PARALLEL_BFS_ENABLE_STATS option of CMake). Otherwise, every hook below is empty and compiled away.
+#ifndef PARALLEL_BFS_ENABLE_STATS
+#define PARALLEL_BFS_ENABLE_STATS 0
+#endif
+
+
+namespace parallel_bfs {
+    inline constexpr bool search_stats_enabled = PARALLEL_BFS_ENABLE_STATS != 0;
+
+
+    /// Work done by one thread during a search.
+    struct ThreadSearchStats {
+        std::uint64_t goal_tests{0};
+        std::uint64_t expansions{0};
+        std::uint64_t max_frontier{0}; ///< Largest frontier seen by the thread
+        std::uint64_t handoffs{0};     ///< Nodes or batches of nodes given to or taken from other threads (e.g. steals)
+        std::chrono::nanoseconds busy{0}; ///< Searching, i.e. not waiting for work, for other threads or for a task
+        std::chrono::nanoseconds idle{0}; ///< The rest of the search
+    };
+
+
+    /**
+     * @brief Work done during a search, from reset_search_stats() to collect_search_stats().
+     *
+     * Busy time is measured for the thread that runs the search (except while it waits for other threads) and for the
+     * tasks of ThreadPool and std::async. Other threads (e.g. of the parallel algorithms of the standard library) only
+     * report counts. The frontier of each thread is different in each algorithm (e.g. a shared queue or a deque of
+     * stolen work), so max_frontier is the largest of the frontiers seen by any thread, not their sum. Busy and idle
+     * times are wall-clock times: with more threads than CPUs, a thread that is preempted while busy stays busy.
+     */
+    struct SearchStats {
+        std::uint64_t goal_tests{0};
+        std::uint64_t expansions{0};
+        std::uint64_t max_frontier{0};
+        std::uint64_t handoffs{0};
+        std::chrono::nanoseconds wall_time{0};
+        std::optional<std::chrono::nanoseconds> shutdown{}; ///< From the first stop request to the end of the search
+        std::vector<ThreadSearchStats> threads{}; ///< Threads that did some work
+
+        [[nodiscard]] std::chrono::nanoseconds busy() const {
+            std::chrono::nanoseconds total{0};
+            for (const auto &thread: threads) total += thread.busy;
+            return total;
+        }
+
+        [[nodiscard]] std::chrono::nanoseconds idle() const {
+            std::chrono::nanoseconds total{0};
+            for (const auto &thread: threads) total += thread.idle;
+            return total;
+        }
+    };
+}
+
+
+namespace parallel_bfs::detail {
+    using stats_clock = std::chrono::steady_clock;
+
+
+    /// Counters of one thread. Only that thread updates them, with relaxed loads and stores (plain moves in the usual
+    /// architectures). Other threads only read or reset them between searches.
+    struct ThreadStatsCounters {
+        std::atomic<std::uint64_t> goal_tests{0};
+        std::atomic<std::uint64_t> expansions{0};
+        std::atomic<std::uint64_t> max_frontier{0};
+        std::atomic<std::uint64_t> handoffs{0};
+        std::atomic<std::int64_t> task_ns{0}; ///< Inside BusyScope
+        std::atomic<std::int64_t> wait_ns{0}; ///< Inside IdleScope
+
+        template<typename T>
+        static void add(std::atomic<T> &counter, T value) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        void reset() noexcept {
+            for (auto *counter: {&goal_tests, &expansions, &max_frontier, &handoffs}) counter->store(0, std::memory_order_relaxed);
+            task_ns.store(0, std::memory_order_relaxed);
+            wait_ns.store(0, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] ThreadSearchStats snapshot(std::chrono::nanoseconds wall_time) const noexcept {
+            ThreadSearchStats stats;
+            stats.goal_tests = goal_tests.load(std::memory_order_relaxed);
+            stats.expansions = expansions.load(std::memory_order_relaxed);
+            stats.max_frontier = max_frontier.load(std::memory_order_relaxed);
+            stats.handoffs = handoffs.load(std::memory_order_relaxed);
+            const std::int64_t busy = task_ns.load(std::memory_order_relaxed) - wait_ns.load(std::memory_order_relaxed);
+            stats.busy = std::chrono::nanoseconds{std::max<std::int64_t>(busy, 0)};
+            stats.idle = std::max(wall_time - stats.busy, std::chrono::nanoseconds{0});
+            return stats;
+        }
+
+        /// Whether the thread did nothing but wait (e.g. the caller of ThreadPool::run_on_all).
+        [[nodiscard]] bool empty() const noexcept {
+            return goal_tests.load(std::memory_order_relaxed) == 0 && expansions.load(std::memory_order_relaxed) == 0 &&
+                   handoffs.load(std::memory_order_relaxed) == 0 &&
+                   task_ns.load(std::memory_order_relaxed) <= wait_ns.load(std::memory_order_relaxed);
+        }
+    };
+
+
+    /// Counters of all the threads alive, and a snapshot of those that exited since the last reset.
+    class StatsRegistry {
+    public:
+        [[nodiscard]] static StatsRegistry &instance() {
+            static StatsRegistry registry;
+            return registry;
+        }
+
+        void add(std::shared_ptr<ThreadStatsCounters> counters) {
+            std::lock_guard lock{_mutex};
+            _threads.push_back(std::move(counters));
+        }
+
+        void retire(const std::shared_ptr<ThreadStatsCounters> &counters) {
+            std::lock_guard lock{_mutex};
+            if (!counters->empty()) _retired.push_back(counters->snapshot(std::chrono::duration_cast<std::chrono::nanoseconds>(stats_clock::now() - _start)));
+            std::erase(_threads, counters);
+        }
+
+        void reset(ThreadStatsCounters &caller) {
+            std::lock_guard lock{_mutex};
+            for (const auto &counters: _threads) counters->reset();
+            _retired.clear();
+            _caller = &caller;
+            _stop_ns.store(0, std::memory_order_relaxed);
+            _start = stats_clock::now();
+        }
+
+        [[nodiscard]] SearchStats collect() {
+            const auto end = stats_clock::now();
+            std::lock_guard lock{_mutex};
+            SearchStats stats;
+            stats.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start);
+            if (_caller) ThreadStatsCounters::add(_caller->task_ns, static_cast<std::int64_t>(stats.wall_time.count()));
+            if (const std::int64_t stop = _stop_ns.load(std::memory_order_relaxed); stop != 0)
+                stats.shutdown = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()) - std::chrono::nanoseconds{stop};
+
+            stats.threads = _retired;
+            for (const auto &counters: _threads)
+                if (!counters->empty()) stats.threads.push_back(counters->snapshot(stats.wall_time));
+            for (const auto &thread: stats.threads) {
+                stats.goal_tests += thread.goal_tests;
+                stats.expansions += thread.expansions;
+                stats.max_frontier = std::max(stats.max_frontier, thread.max_frontier);
+                stats.handoffs += thread.handoffs;
+            }
+            _caller = nullptr;
+            return stats;
+        }
+
+        /// Only the first stop request of a search is recorded.
+        void note_stop() noexcept {
+            std::int64_t expected = 0;
+            if (_stop_ns.load(std::memory_order_relaxed) == 0)
+                _stop_ns.compare_exchange_strong(expected, std::chrono::duration_cast<std::chrono::nanoseconds>(stats_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<ThreadStatsCounters>> _threads{};
+        std::vector<ThreadSearchStats> _retired{};
+        ThreadStatsCounters *_caller{nullptr};
+        stats_clock::time_point _start{stats_clock::now()};
+        std::atomic<std::int64_t> _stop_ns{0};
+    };
+
+
+    /// Registers the counters of a thread when it first uses them, and keeps their values when the thread exits.
+    struct ThreadStatsHandle {
+        std::shared_ptr<ThreadStatsCounters> counters{std::make_shared<ThreadStatsCounters>()};
+
+        ThreadStatsHandle() { StatsRegistry::instance().add(counters); }
+
+        ~ThreadStatsHandle() { StatsRegistry::instance().retire(counters); }
+    };
+
+
+    [[nodiscard]] inline ThreadStatsCounters &thread_stats() {
+        thread_local ThreadStatsHandle handle;
+        return *handle.counters;
+    }
+
+
+    inline void count_goal_tests([[maybe_unused]] std::uint64_t count) noexcept {
+        if constexpr (search_stats_enabled) ThreadStatsCounters::add(thread_stats().goal_tests, count);
+    }
+
+    inline void count_expansion() noexcept {
+        if constexpr (search_stats_enabled) ThreadStatsCounters::add(thread_stats().expansions, std::uint64_t{1});
+    }
+
+    inline void count_handoffs([[maybe_unused]] std::uint64_t count = 1) noexcept {
+        if constexpr (search_stats_enabled) ThreadStatsCounters::add(thread_stats().handoffs, count);
+    }
+
+    inline void record_frontier([[maybe_unused]] std::uint64_t size) noexcept {
+        if constexpr (search_stats_enabled) {
+            auto &max_frontier = thread_stats().max_frontier;
+            if (size > max_frontier.load(std::memory_order_relaxed)) max_frontier.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    /// Call it wherever a search is told to stop (e.g. when a solution is found) to measure how long it takes to end.
+    inline void note_stop_request() noexcept {
+        if constexpr (search_stats_enabled) StatsRegistry::instance().note_stop();
+    }
+
+
+    /// Adds the time spent in its scope to the busy (Idle = false) or the idle (Idle = true) time of the thread. When
+    /// tracing, it is also recorded as a "task" or a "wait" event.
+    template<bool Idle>
+    class ScopedStatsTimer {
+    public:
+        ScopedStatsTimer() noexcept {
+            if constexpr (search_stats_enabled || search_trace_enabled) _start = stats_clock::now();
+        }
+
+        ScopedStatsTimer(const ScopedStatsTimer &) = delete;
+
+        ScopedStatsTimer &operator=(const ScopedStatsTimer &) = delete;
+
+        ~ScopedStatsTimer() {
+            if constexpr (search_stats_enabled) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(stats_clock::now() - _start).count();
+                ThreadStatsCounters::add(Idle ? thread_stats().wait_ns : thread_stats().task_ns, static_cast<std::int64_t>(elapsed));
+            }
+            trace_span(Idle ? "wait" : "task", _start);
+        }
+
+    private:
+        stats_clock::time_point _start{};
+    };
+
+    using BusyScope = ScopedStatsTimer<false>;
+    using IdleScope = ScopedStatsTimer<true>;
+}
+
+
+namespace parallel_bfs {
+    /// Starts collecting statistics of a search that runs on the calling thread. Does nothing if they are disabled.
+    inline void reset_search_stats() {
+        if constexpr (search_stats_enabled) detail::StatsRegistry::instance().reset(detail::thread_stats());
+    }
+
+    /// Statistics since the last reset_search_stats(), which must have been called on the same thread. Empty if they
+    /// are disabled.
+    [[nodiscard]] inline std::optional<SearchStats> collect_search_stats() {
+        if constexpr (search_stats_enabled) return detail::StatsRegistry::instance().collect();
+        else return std::nullopt;
+    }
+}
+
+#endif //PARALLEL_BFS_SEARCH_STATS_H
@@ -0,0 +1,120 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_ARENA_BFS_H
+#define PARALLEL_BFS_PROJECT_ARENA_BFS_H
+
+#include <vector>
+#include <memory>
+#include <future>
+#include <thread>
+#include <deque>
+#include <stop_token>
+#include <algorithm>
+#include "../closed_list.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    template<Searchable State>
+    using ArenaFrontier = std::deque<const ArenaNode<State> *>;
+
+
+    /// Same as _bfs, but nodes are allocated in @arena and handled through raw pointers.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] const ArenaNode<State> *
+    _arena_bfs(ArenaFrontier<State> &frontier,
+               const Problem<State, TM> &problem,
+               NodeArena<State> &arena,
+               Closed &closed,
+               std::stop_source ssource = std::stop_source{},
+               std::size_t limit = std::numeric_limits<std::size_t>::max()) {
+        while (!frontier.empty() && !ssource.stop_requested() && frontier.size() < limit) {
+            const ArenaNode<State> *node = frontier.front();
+            frontier.pop_front();
+            if (problem.is_goal(node->state())) {
+                note_stop_request();
+                ssource.request_stop();
+                return node;
+            }
+            problem.expand(node, arena, [&frontier, &closed](const ArenaNode<State> *child) {
+                if (closed.insert(child->state())) frontier.push_back(child);
+            });
+            record_frontier(frontier.size());
+        }
+
+        if (ssource.stop_requested()) trace_instant("stop observed");
+        return nullptr;
+    }
+}
+
+
+namespace parallel_bfs {
+    /// Sequential BFS that allocates its nodes in a single arena, which is released in bulk when the search ends.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> arena_sync_bfs(const Problem<State, TM> &problem) {
+        NodeArena<State> arena;
+        detail::ArenaFrontier<State> frontier{arena.make_node(problem.initial())};
+        detail::closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+        return detail::to_shared_node(detail::_arena_bfs(frontier, problem, arena, closed));
+    }
+
+
+    /// Same strategy as tasks_bfs, but each thread allocates the nodes that it expands in its own arena.
+    /// With SearchMode::Graph, all threads share a concurrent closed list, so no state is expanded twice.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> arena_tasks_bfs(const Problem<State, TM> &problem, ThreadPool &pool, unsigned int starting_points_per_thread = 4) {
+        const unsigned int num_threads = pool.size();
+        const unsigned int min_starting_points = num_threads * std::max(starting_points_per_thread, 1u);
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+
+        // First fill the frontier with enough starting points
+        NodeArena<State> main_arena;
+        detail::ArenaFrontier<State> frontier{main_arena.make_node(problem.initial())};
+        auto possible_solution = detail::_arena_bfs(frontier, problem, main_arena, closed, std::stop_source{}, min_starting_points);
+        if (possible_solution != nullptr) return detail::to_shared_node(possible_solution);
+
+        // Split the frontier into as many subfrontiers as threads
+        std::vector<detail::ArenaFrontier<State>> subfrontiers(num_threads);
+        while (!frontier.empty()) {
+            for (std::size_t i = 0; i < subfrontiers.size() && !frontier.empty(); ++i) {
+                subfrontiers[i].push_back(frontier.front());
+                frontier.pop_front();
+            }
+        }
+
+        // Launch a task for each subfrontier. All arenas must outlive the tasks and the final path copy.
+        std::vector<NodeArena<State>> arenas(num_threads);
+        std::vector<std::future<const ArenaNode<State> *>> futures;
+        std::stop_source stop_source{};
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            futures.push_back(pool.submit([&problem, &closed, &subfrontier = subfrontiers[i], &arena = arenas[i], stop_source] {
+                return detail::_arena_bfs(subfrontier, problem, arena, closed, stop_source);
+            }));
+        }
+
+        const ArenaNode<State> *solution{nullptr};
+        const detail::IdleScope waiting;
+        for (auto &future: futures) // Ensure that all threads have finished to avoid data races
+            if (auto result = future.get(); result != nullptr) solution = result;
+        return detail::to_shared_node(solution);
+    }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> arena_tasks_bfs(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return arena_tasks_bfs<State, TM, Mode>(problem, pool);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_ARENA_BFS_H
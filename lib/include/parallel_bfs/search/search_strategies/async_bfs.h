@@ -9,6 +9,7 @@
 #include <vector>
 #include <memory>
 #include <thread>
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
@@ -16,8 +17,8 @@
 
 
 namespace parallel_bfs::detail {
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
-    [[nodiscard]] std::shared_ptr<Node<State>> async_bfs_recursive(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, std::stop_source stop_source) {
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] std::shared_ptr<Node<State>> async_bfs_recursive(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, Closed &closed, std::stop_source stop_source) {
         if (problem.is_goal(init_node->state())) return init_node;
         std::vector<std::future<std::shared_ptr<Node<State>>>> futures;
 
@@ -25,15 +26,21 @@ namespace parallel_bfs::detail {
 
         for (const auto &child: problem.expand(init_node)) {
             if (stop_source.stop_requested()) break;
-            auto future = std::async([&problem, stop_source](std::shared_ptr<Node<State>> node) {
-                auto solution {detail::async_bfs_recursive(std::move(node), problem, stop_source)};
-                if (solution != nullptr) stop_source.request_stop();
+            if (!closed.insert(child->state())) continue;
+            auto future = std::async([&problem, &closed, stop_source](std::shared_ptr<Node<State>> node) {
+                const BusyScope busy;
+                auto solution {detail::async_bfs_recursive(std::move(node), problem, closed, stop_source)};
+                if (solution != nullptr) {
+                    note_stop_request();
+                    stop_source.request_stop();
+                }
                 return solution;
             }, std::move(child));
             futures.push_back(std::move(future));
         }
 
         std::shared_ptr<Node<State>> solution{nullptr};
+        const IdleScope waiting;
         for (auto &future: futures) // Ensure that all threads have finished to avoid data races
             if (auto result = future.get(); result != nullptr) solution = result;
         return solution;
@@ -42,11 +49,13 @@ namespace parallel_bfs::detail {
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, ParallelBFSTasks only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// With SearchMode::Graph, all threads share a concurrent closed list, so no state is expanded twice.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
     [[nodiscard]] std::shared_ptr<Node<State>> async_bfs(const Problem<State, TM> &problem) {
         auto init_node = std::make_shared<Node<State>>(problem.initial());
-        return detail::async_bfs_recursive(std::move(init_node), problem, std::stop_source{});
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+        return detail::async_bfs_recursive(std::move(init_node), problem, closed, std::stop_source{});
     }
 }
 
@@ -10,22 +10,60 @@
 #include <memory>
 #include <thread>
 #include <deque>
+#include <algorithm>
 #include "bfs.h"
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
+#include "../thread_pool.h"
 #include "../transition_model.h"
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, async_start_bfs only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// Submits one task per starting point to @pool, with at least @starting_points_per_thread starting points per
+    /// worker. With SearchMode::Graph, all threads share a concurrent closed list, so no state is expanded twice.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> async_start_bfs(const Problem<State, TM> &problem, ThreadPool &pool, unsigned int starting_points_per_thread = 4) {
+        std::deque<std::shared_ptr<Node<State>>> frontier{std::make_shared<Node<State>>(problem.initial())};
+        unsigned int min_starting_points = pool.size() * std::max(starting_points_per_thread, 1u);
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+
+        // First fill the frontier with enough starting points
+        auto possible_solution = detail::bfs_with_limit(frontier, problem, closed, min_starting_points);
+        if (possible_solution != nullptr) return possible_solution;
+
+        // Then start a parallel search from each starting point
+        std::vector<std::future<std::shared_ptr<Node<State>>>> futures;
+        std::stop_source stop_source{};
+
+        while (!frontier.empty()) {
+            auto future = pool.submit([&problem, &closed, stop_source](std::shared_ptr<Node<State>> node) {
+                return detail::interruptible_bfs(std::move(node), problem, closed, stop_source);
+            }, frontier.front());
+            frontier.pop_front();
+            futures.push_back(std::move(future));
+        }
+
+        std::shared_ptr<Node<State>> solution{nullptr};
+        const detail::IdleScope waiting;
+        for (auto &future: futures) // Ensure that all threads have finished to avoid data races
+            if (auto result = future.get(); result != nullptr) solution = result;
+        return solution;
+    }
+
+
+    /// Same as above, but every starting point gets its own thread (std::async).
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
     [[nodiscard]] std::shared_ptr<Node<State>> async_start_bfs(const Problem<State, TM> &problem) {
         std::deque<std::shared_ptr<Node<State>>> frontier{std::make_shared<Node<State>>(problem.initial())};
         unsigned int min_starting_points = std::thread::hardware_concurrency() * 4;
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
 
         // First fill the frontier with enough starting points
-        auto possible_solution = detail::bfs_with_limit(frontier, problem, min_starting_points);
+        auto possible_solution = detail::bfs_with_limit(frontier, problem, closed, min_starting_points);
         if (possible_solution != nullptr) return possible_solution;
 
         // Then start a parallel search from each starting point
@@ -33,14 +71,16 @@ namespace parallel_bfs {
         std::stop_source stop_source{};
 
         while (!frontier.empty()) {
-            auto future = std::async(std::launch::async, [&problem, stop_source](std::shared_ptr<Node<State>> node) {
-                return detail::interruptible_bfs(std::move(node), problem, stop_source);
+            auto future = std::async(std::launch::async, [&problem, &closed, stop_source](std::shared_ptr<Node<State>> node) {
+                const detail::BusyScope busy;
+                return detail::interruptible_bfs(std::move(node), problem, closed, stop_source);
             }, frontier.front());
             frontier.pop_front();
             futures.push_back(std::move(future));
         }
 
         std::shared_ptr<Node<State>> solution{nullptr};
+        const detail::IdleScope waiting;
         for (auto &future: futures) // Ensure that all threads have finished to avoid data races
             if (auto result = future.get(); result != nullptr) solution = result;
         return solution;
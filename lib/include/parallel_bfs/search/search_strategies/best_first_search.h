@@ -0,0 +1,120 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_BEST_FIRST_SEARCH_H
+#define PARALLEL_BFS_PROJECT_BEST_FIRST_SEARCH_H
+
+#include <memory>
+#include <concepts>
+#include <unordered_map>
+#include <type_traits>
+#include "../closed_list.h"
+#include "../priority_queue.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs {
+    /// A heuristic estimates the cost from a state to the closest goal. It must never overestimate it (admissible)
+    /// for A* to return an optimal solution.
+    template<typename H, typename State>
+    concept Heuristic = Searchable<State> && std::default_initializable<H> && requires(const H &h, const State &s) {
+        { h(s) } -> std::convertible_to<int>;
+    };
+
+
+    /// Heuristic that turns A* into uniform-cost search.
+    template<Searchable State>
+    struct ZeroHeuristic {
+        constexpr int operator()(const State &) const noexcept { return 0; }
+    };
+}
+
+
+namespace parallel_bfs::detail {
+    /// Graph search keeps the lowest path cost found for each state, so that worse paths to a state are discarded.
+    template<Searchable State>
+    class BestCostTable {
+    public:
+        /// Returns true (and records @g) if @g is lower than any cost previously recorded for @state.
+        bool improve(const State &state, int g) {
+            auto [it, inserted] = _best.try_emplace(state, g);
+            if (inserted) return true;
+            if (g >= it->second) return false;
+            it->second = g;
+            return true;
+        }
+
+        /// Returns true if a path to @state cheaper than @g has been recorded.
+        [[nodiscard]] bool is_stale(const State &state, int g) const {
+            auto it = _best.find(state);
+            return it != _best.end() && it->second < g;
+        }
+
+    private:
+        std::unordered_map<State, int> _best{};
+    };
+
+
+    /// Tree-like search does not check for repeated states.
+    template<Searchable State>
+    class NoBestCostTable {
+    public:
+        constexpr bool improve(const State &, int) noexcept { return true; }
+
+        [[nodiscard]] constexpr bool is_stale(const State &, int) const noexcept { return false; }
+    };
+
+
+    template<Searchable State, SearchMode Mode>
+    using best_cost_table_t = std::conditional_t<Mode == SearchMode::Graph, BestCostTable<State>, NoBestCostTable<State>>;
+
+
+    /// Best-first search ordered by f = g + h. Nodes are goal-tested when they are popped, which is required for the
+    /// solution to be optimal. Integer costs allow using a bucket queue as the open list.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, Heuristic<State> H, SearchMode Mode>
+    [[nodiscard]] const ArenaNode<State> *_best_first_search(const Problem<State, TM> &problem, NodeArena<State> &arena, const H &heuristic) {
+        BucketQueue<const ArenaNode<State> *> open;
+        best_cost_table_t<State, Mode> best;
+
+        const ArenaNode<State> *root = arena.make_node(problem.initial());
+        best.improve(root->state(), 0);
+        open.push(heuristic(root->state()), root);
+
+        while (!open.empty()) {
+            const ArenaNode<State> *node = open.pop();
+            if (best.is_stale(node->state(), node->path_cost())) continue;
+            if (problem.is_goal(node->state())) return node;
+            problem.expand(node, arena, [&open, &best, &heuristic](const ArenaNode<State> *child) {
+                if (best.improve(child->state(), child->path_cost()))
+                    open.push(child->path_cost() + heuristic(child->state()), child);
+            });
+            record_frontier(open.size());
+        }
+
+        return nullptr;
+    }
+}
+
+
+namespace parallel_bfs {
+    /// A* search with the heuristic @H. With SearchMode::Graph, worse paths to already reached states are discarded.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, Heuristic<State> H, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> astar_search(const Problem<State, TM> &problem) {
+        NodeArena<State> arena;
+        return detail::to_shared_node(detail::_best_first_search<State, TM, H, Mode>(problem, arena, H{}));
+    }
+
+
+    /// Uniform-cost search (Dijkstra): best-first search ordered by path cost.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> uniform_cost_search(const Problem<State, TM> &problem) {
+        return astar_search<State, TM, ZeroHeuristic<State>, Mode>(problem);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_BEST_FIRST_SEARCH_H
@@ -8,7 +8,12 @@
 #include <memory>
 #include <queue>
 #include <deque>
+#include <bit>
+#include <ranges>
+#include <cstdint>
+#include <algorithm>
 #include <stop_token>
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
@@ -16,24 +21,44 @@
 
 
 namespace parallel_bfs::detail {
-    /// NOTE: We use tree-like search, so we don't need to check for repeated states
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// States are added to @closed when they are generated, and children whose state was already in @closed are
+    /// discarded. With NoClosedList this is plain tree-like search.
+    /// The front of the frontier is goal-tested in batches (see Problem::goal_mask), and then its nodes are expanded
+    /// one by one. The first goal of a batch is the node that a node-by-node search would have returned. With a
+    /// @limit, the frontier is handed to other searches when it is reached, so nodes are tested one at a time to
+    /// never test a node that is not expanded.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
     [[nodiscard]] std::shared_ptr<Node<State>>
     _bfs(std::deque<std::shared_ptr<Node<State>>> &frontier,
          const Problem<State, TM> &problem,
+         Closed &closed,
          std::stop_source ssource = std::stop_source{},
          std::size_t limit = std::numeric_limits<std::size_t>::max()) {
+        constexpr auto node_state = [](const std::shared_ptr<Node<State>> &node) -> const State & { return node->state(); };
+
+        const std::size_t max_batch = limit == std::numeric_limits<std::size_t>::max() ? Problem<State, TM>::goal_batch_size : 1;
+
         while (!frontier.empty() && !ssource.stop_requested() && frontier.size() < limit) {
-            auto node = frontier.front();
-            frontier.pop_front();
-            if (problem.is_goal(node->state())) {
+            const std::size_t batch = std::min(frontier.size(), max_batch);
+            const std::uint64_t goals = problem.goal_mask(std::ranges::subrange(frontier.begin(), frontier.begin() + batch), node_state, ssource.get_token());
+            if (goals != 0) {
+                note_stop_request();
                 ssource.request_stop();
-                return node;
+                return frontier[std::countr_zero(goals)];
+            }
+
+            // A stop request ends the search, so the nodes of the batch that are not expanded are never tested again
+            for (std::size_t i = 0; i < batch && !ssource.stop_requested(); ++i) {
+                auto node = std::move(frontier.front());
+                frontier.pop_front();
+                problem.expand(node, [&frontier, &closed](std::shared_ptr<Node<State>> &&child) {
+                    if (closed.insert(child->state())) frontier.push_back(std::move(child));
+                });
             }
-            // frontier.push_range(problem.expand(node)); // TODO: Use this when available
-            for (const auto &child: problem.expand(std::move(node))) frontier.push_back(child);
+            record_frontier(frontier.size());
         }
 
+        if (ssource.stop_requested()) trace_instant("stop observed");
         return nullptr;
     }
 
@@ -42,15 +67,34 @@ namespace parallel_bfs::detail {
     template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
     [[nodiscard]] std::shared_ptr<Node<State>>
     interruptible_bfs(std::deque<std::shared_ptr<Node<State>>> &frontier, const Problem<State, TM> &problem, std::stop_source ssource = std::stop_source{}) {
-        return _bfs(frontier, problem, ssource);
+        NoClosedList<State> closed;
+        return _bfs(frontier, problem, closed, ssource);
+    }
+
+
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] std::shared_ptr<Node<State>>
+    interruptible_bfs(std::deque<std::shared_ptr<Node<State>>> &frontier, const Problem<State, TM> &problem, Closed &closed, std::stop_source ssource = std::stop_source{}) {
+        return _bfs(frontier, problem, closed, ssource);
     }
 
 
+    /// NOTE: We use tree-like search, so we don't need to check for repeated states
     template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
     [[nodiscard]] std::shared_ptr<Node<State>>
     interruptible_bfs(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, std::stop_source ssource = std::stop_source{}) {
         std::deque<std::shared_ptr<Node<State>>> frontier({std::move(init_node)});
-        return _bfs(frontier, problem, ssource);
+        NoClosedList<State> closed;
+        return _bfs(frontier, problem, closed, ssource);
+    }
+
+
+    /// NOTE: @init_node must already be in @closed
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] std::shared_ptr<Node<State>>
+    interruptible_bfs(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, Closed &closed, std::stop_source ssource = std::stop_source{}) {
+        std::deque<std::shared_ptr<Node<State>>> frontier({std::move(init_node)});
+        return _bfs(frontier, problem, closed, ssource);
     }
 
 
@@ -58,7 +102,15 @@ namespace parallel_bfs::detail {
     template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
     [[nodiscard]] std::shared_ptr<Node<State>>
     bfs_with_limit(std::deque<std::shared_ptr<Node<State>>> &frontier, const Problem<State, TM> &problem, std::size_t limit) {
-        return _bfs(frontier, problem, std::stop_source{}, limit);
+        NoClosedList<State> closed;
+        return _bfs(frontier, problem, closed, std::stop_source{}, limit);
+    }
+
+
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] std::shared_ptr<Node<State>>
+    bfs_with_limit(std::deque<std::shared_ptr<Node<State>>> &frontier, const Problem<State, TM> &problem, Closed &closed, std::size_t limit) {
+        return _bfs(frontier, problem, closed, std::stop_source{}, limit);
     }
 }
 
@@ -0,0 +1,306 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_BIDIRECTIONAL_BFS_H
+#define PARALLEL_BFS_PROJECT_BIDIRECTIONAL_BFS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <barrier>
+#include <span>
+#include <limits>
+#include <cstdint>
+#include <concepts>
+#include <algorithm>
+#include "../problem.h"
+#include "../node.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    /// Graphs whose states are the integers [0, size()) and that can list the predecessors of a state (e.g. CsrGraph).
+    template<typename TM, typename State>
+    concept ReversibleGraph = std::unsigned_integral<State> && sizeof(State) <= sizeof(std::uint32_t) &&
+                              requires(const TM &tm, const State &state) {
+        { tm.size() } -> std::convertible_to<std::size_t>;
+        { tm.successors(state) } -> std::convertible_to<std::span<const State>>;
+        { tm.reversed() } -> std::same_as<TM>;
+    };
+
+
+    /**
+     * @brief Visit record of a state in one direction of a bidirectional search.
+     *
+     * It packs the depth of the state and its parent in that direction in a single word, so that it can be claimed
+     * with one atomic operation: 0 means not visited, and otherwise it is (depth + 1) << 32 | parent. The parent of a
+     * root (the initial state, or a goal) is the root itself. In the backward direction, the parent of a state is the
+     * next state on the way to a goal.
+     */
+    class VisitRecord {
+    public:
+        static constexpr std::uint64_t unvisited = 0;
+
+        [[nodiscard]] static constexpr std::uint64_t make(std::uint32_t depth, std::uint32_t parent) noexcept {
+            return (static_cast<std::uint64_t>(depth) + 1) << 32 | parent;
+        }
+
+        [[nodiscard]] static constexpr std::uint32_t depth(std::uint64_t record) noexcept {
+            return static_cast<std::uint32_t>((record >> 32) - 1);
+        }
+
+        [[nodiscard]] static constexpr std::uint32_t parent(std::uint64_t record) noexcept {
+            return static_cast<std::uint32_t>(record);
+        }
+    };
+
+
+    /**
+     * @brief Builds the solution node of a bidirectional search that met at @meet.
+     *
+     * @param forward_record Returns the forward VisitRecord of a state.
+     * @param backward_record Returns the backward VisitRecord of a state.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, typename Forward, typename Backward>
+    [[nodiscard]] std::shared_ptr<Node<State>>
+    join_paths(const Problem<State, TM> &problem, State meet, Forward &&forward_record, Backward &&backward_record) {
+        std::vector<State> path;
+        for (State state = meet;; state = static_cast<State>(VisitRecord::parent(forward_record(state)))) {
+            path.push_back(state);
+            if (VisitRecord::parent(forward_record(state)) == state) break;
+        }
+        std::reverse(path.begin(), path.end());
+        for (State state = meet; VisitRecord::parent(backward_record(state)) != state;) {
+            state = static_cast<State>(VisitRecord::parent(backward_record(state)));
+            path.push_back(state);
+        }
+
+        auto node = std::make_shared<Node<State>>(path.front());
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            int cost = 0;
+            problem.for_each_successor(path[i - 1], [&path, i, &cost](State &&next, int c) { if (next == path[i]) cost = c; });
+            node = std::make_shared<Node<State>>(path[i], node, node->path_cost() + cost);
+        }
+        return node;
+    }
+
+
+    /**
+     * @brief Parallel bidirectional BFS: one group of threads searches forward from the initial state, and another one
+     * backward from the goals, at the same time.
+     *
+     * Both directions advance one level per round, and the threads of a group split the frontier of their direction in
+     * contiguous chunks. A state is claimed in each direction with a single compare-and-swap on its VisitRecord, and the
+     * thread that claims it checks the record of the other direction: the second claim of a state always sees the
+     * first one, so every meeting point is found. Meetings found in round k have length at most 2k, and a shortest
+     * path of length L is found in round ceil(L/2), so the shortest meeting of the first round that finds any is a
+     * shortest path.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    requires ReversibleGraph<TM, State>
+    class BidirectionalSearch {
+    public:
+        /// Half of the workers of @pool search forward, and the other half backward. A single worker does both.
+        explicit BidirectionalSearch(const Problem<State, TM> &problem, ThreadPool &pool)
+                : _problem{problem}, _pool{pool}, _num_threads{pool.size()},
+                  _forward{problem.transition_model(), 0, std::max(1u, _num_threads / 2)},
+                  _backward{problem.transition_model().reversed(), _num_threads > 1 ? _num_threads / 2 : 0, std::max(1u, _num_threads - _num_threads / 2)} {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            const State initial = _problem.initial();
+            _forward.visits[initial].store(VisitRecord::make(0, initial), std::memory_order_relaxed);
+            _forward.frontier.push_back(initial);
+            for (const State &goal: _problem.goal_states()) {
+                if (goal >= _backward.visits.size()) continue; // Not in the graph, so not reachable
+                if (_backward.visits[goal].exchange(VisitRecord::make(0, goal), std::memory_order_relaxed) == VisitRecord::unvisited)
+                    _backward.frontier.push_back(goal);
+            }
+            if (_backward.visits[initial].load(std::memory_order_relaxed) != VisitRecord::unvisited) return solution(initial);
+
+            _finished = _backward.frontier.empty();
+            std::barrier sync_point{static_cast<std::ptrdiff_t>(_num_threads), PhaseCompletion{this}};
+            _pool.run_on_all([this, &sync_point](unsigned int id) { run(id, sync_point); });
+
+            const std::uint64_t best = _best.load(std::memory_order_relaxed);
+            return best == no_meeting ? nullptr : solution(static_cast<State>(best & 0xffffffff));
+        }
+
+    private:
+        static constexpr std::uint64_t no_meeting = std::numeric_limits<std::uint64_t>::max();
+
+        struct Direction {
+            /// Every state enters the frontier at most once, so reserving the size of the graph lets end_round()
+            /// refill the frontier without allocating (the completion of a barrier must not throw).
+            Direction(TM graph, unsigned int first_thread, unsigned int num_threads)
+                    : graph{std::move(graph)}, visits(this->graph.size()), buffers(num_threads),
+                      first_thread{first_thread}, num_threads{num_threads} {
+                frontier.reserve(this->graph.size());
+            }
+
+            [[nodiscard]] bool has_thread(unsigned int id) const noexcept { return id >= first_thread && id < first_thread + num_threads; }
+
+            const TM graph;
+            std::vector<std::atomic<std::uint64_t>> visits; // VisitRecord of each state
+            std::vector<State> frontier{};
+            std::vector<std::vector<State>> buffers; // One output buffer per thread of the group
+            const unsigned int first_thread;
+            const unsigned int num_threads;
+        };
+
+        /// Runs on a single thread after all threads have arrived at the barrier.
+        struct PhaseCompletion {
+            BidirectionalSearch *self;
+
+            void operator()() noexcept { self->end_round(); }
+        };
+
+        template<typename Barrier>
+        void run(unsigned int id, Barrier &sync_point) {
+            while (!_finished) {
+                if (_forward.has_thread(id)) expand(_forward, _backward, id - _forward.first_thread);
+                if (_backward.has_thread(id)) expand(_backward, _forward, id - _backward.first_thread);
+                const IdleScope idle;
+                sync_point.arrive_and_wait();
+            }
+        }
+
+        /// Expands the chunk of the frontier of @self assigned to thread @index of its group.
+        void expand(Direction &self, const Direction &other, unsigned int index) {
+            std::vector<State> &buffer = self.buffers[index];
+            const std::size_t size = self.frontier.size();
+            const std::size_t begin = size * index / self.num_threads, end = size * (index + 1) / self.num_threads;
+            const auto &workload = _problem.workload();
+
+            for (std::size_t i = begin; i < end; ++i) {
+                const State state = self.frontier[i];
+                count_expansion();
+                const std::uint32_t depth = VisitRecord::depth(self.visits[state].load(std::memory_order_relaxed)) + 1;
+                for (const State next: self.graph.successors(state)) {
+                    std::uint64_t expected = VisitRecord::unvisited;
+                    if (self.visits[next].load(std::memory_order_relaxed) != VisitRecord::unvisited ||
+                        !self.visits[next].compare_exchange_strong(expected, VisitRecord::make(depth, state))) continue;
+
+                    count_goal_tests(1);
+                    if (workload) workload->run(std::hash<State>{}(next)); // Every claim is a goal (meeting) test
+                    buffer.push_back(next);
+                    if (const std::uint64_t record = other.visits[next].load(); record != VisitRecord::unvisited)
+                        update_best(static_cast<std::uint64_t>(depth + VisitRecord::depth(record)) << 32 | next);
+                }
+            }
+        }
+
+        void end_round() noexcept {
+            for (Direction *direction: {&_forward, &_backward}) {
+                direction->frontier.clear();
+                for (auto &buffer: direction->buffers) {
+                    direction->frontier.insert(direction->frontier.end(), buffer.begin(), buffer.end());
+                    buffer.clear();
+                }
+            }
+            record_frontier(_forward.frontier.size() + _backward.frontier.size());
+            _finished = _best.load(std::memory_order_relaxed) != no_meeting || _forward.frontier.empty() || _backward.frontier.empty();
+        }
+
+        /// Keeps the meeting with the shortest length, stored as length << 32 | state.
+        void update_best(std::uint64_t meeting) noexcept {
+            note_stop_request();
+            std::uint64_t current = _best.load(std::memory_order_relaxed);
+            while (meeting < current && !_best.compare_exchange_weak(current, meeting, std::memory_order_relaxed));
+        }
+
+        [[nodiscard]] std::shared_ptr<Node<State>> solution(State meet) const {
+            return join_paths(_problem, meet,
+                              [this](State s) { return _forward.visits[s].load(std::memory_order_relaxed); },
+                              [this](State s) { return _backward.visits[s].load(std::memory_order_relaxed); });
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const unsigned int _num_threads;
+        Direction _forward;
+        Direction _backward;
+        std::atomic<std::uint64_t> _best{no_meeting};
+        bool _finished{false}; // Written by the barrier completion, read by all threads after the barrier
+    };
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Bidirectional BFS: searches forward from the initial state and backward from the goal states until both
+     * searches meet, so it explores about 2·b^(d/2) states instead of b^d.
+     *
+     * It needs an explicit set of goals and a graph that can list predecessors (see detail::ReversibleGraph), whose
+     * reverse adjacency is built once per graph. Every step expands a whole level of the direction with the smallest
+     * frontier, and the search stops after the first level that finds a meeting point, with the shortest of the
+     * meetings found in it. Therefore, it returns a path with the minimum number of actions, like a graph BFS.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    requires detail::ReversibleGraph<TM, State>
+    [[nodiscard]] std::shared_ptr<Node<State>> bidirectional_bfs(const Problem<State, TM> &problem) {
+        using detail::VisitRecord;
+        const TM &graph = problem.transition_model();
+        const TM reverse = graph.reversed();
+        std::vector<std::uint64_t> forward(graph.size(), VisitRecord::unvisited), backward(graph.size(), VisitRecord::unvisited);
+        std::vector<State> forward_frontier, backward_frontier, next;
+
+        const State initial = problem.initial();
+        forward[initial] = VisitRecord::make(0, initial);
+        forward_frontier.push_back(initial);
+        for (const State &goal: problem.goal_states()) {
+            if (goal >= backward.size() || backward[goal] != VisitRecord::unvisited) continue;
+            backward[goal] = VisitRecord::make(0, goal);
+            backward_frontier.push_back(goal);
+        }
+
+        auto solution = [&](State meet) {
+            return detail::join_paths(problem, meet, [&forward](State s) { return forward[s]; }, [&backward](State s) { return backward[s]; });
+        };
+        if (backward[initial] != VisitRecord::unvisited) return solution(initial);
+
+        std::uint64_t best = std::numeric_limits<std::uint64_t>::max(); // length << 32 | meeting state
+        const auto &workload = problem.workload();
+        while (!forward_frontier.empty() && !backward_frontier.empty()) {
+            const bool is_forward = forward_frontier.size() <= backward_frontier.size();
+            const TM &direction_graph = is_forward ? graph : reverse;
+            std::vector<std::uint64_t> &self = is_forward ? forward : backward;
+            const std::vector<std::uint64_t> &other = is_forward ? backward : forward;
+            std::vector<State> &frontier = is_forward ? forward_frontier : backward_frontier;
+
+            next.clear();
+            for (const State state: frontier) {
+                detail::count_expansion();
+                const std::uint32_t depth = VisitRecord::depth(self[state]) + 1;
+                for (const State successor: direction_graph.successors(state)) {
+                    if (self[successor] != VisitRecord::unvisited) continue;
+                    self[successor] = VisitRecord::make(depth, state);
+                    detail::count_goal_tests(1);
+                    if (workload) workload->run(std::hash<State>{}(successor)); // Every visit is a goal (meeting) test
+                    next.push_back(successor);
+                    if (other[successor] != VisitRecord::unvisited)
+                        best = std::min(best, static_cast<std::uint64_t>(depth + VisitRecord::depth(other[successor])) << 32 | successor);
+                }
+            }
+            if (best != std::numeric_limits<std::uint64_t>::max()) return solution(static_cast<State>(best & 0xffffffff));
+            std::swap(frontier, next);
+            detail::record_frontier(forward_frontier.size() + backward_frontier.size());
+        }
+
+        return nullptr;
+    }
+
+
+    /// Parallel version of the bidirectional BFS above, with a forward and a backward group of workers of @pool.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    requires detail::ReversibleGraph<TM, State>
+    [[nodiscard]] std::shared_ptr<Node<State>> bidirectional_bfs(const Problem<State, TM> &problem, ThreadPool &pool) {
+        detail::BidirectionalSearch<State, TM> search{problem, pool};
+        return search.search();
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_BIDIRECTIONAL_BFS_H
@@ -7,8 +7,10 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 #include <thread>
 #include <execution>
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
@@ -16,18 +18,22 @@
 
 
 namespace parallel_bfs::detail {
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
-    [[nodiscard]] std::shared_ptr<Node<State>> foreach_bfs_recursive(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, std::stop_source stop_source) {
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, ClosedListFor<State> Closed>
+    [[nodiscard]] std::shared_ptr<Node<State>> foreach_bfs_recursive(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, Closed &closed, std::stop_source stop_source) {
         if (problem.is_goal(init_node->state())) return init_node;
 
         if (stop_source.stop_requested()) return nullptr;
 
-        auto children = problem.expand(init_node);
+        std::vector<std::shared_ptr<Node<State>>> children;
+        problem.expand(init_node, [&children, &closed](std::shared_ptr<Node<State>> &&child) {
+            if (closed.insert(child->state())) children.push_back(std::move(child));
+        });
         std::atomic<std::shared_ptr<Node<State>>> solution{nullptr};
 
-        std::for_each(std::execution::par, children.cbegin(), children.cend(), [&problem, stop_source, &solution](const auto &node) {
-            auto possible_solution = detail::foreach_bfs_recursive(node, problem, stop_source);
+        std::for_each(std::execution::par, children.cbegin(), children.cend(), [&problem, &closed, stop_source, &solution](const auto &node) {
+            auto possible_solution = detail::foreach_bfs_recursive(node, problem, closed, stop_source);
             if (possible_solution != nullptr) {
+                detail::note_stop_request();
                 stop_source.request_stop();
                 solution.store(possible_solution);
             }
@@ -39,11 +45,13 @@ namespace parallel_bfs::detail {
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, ParallelBFSTasks only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// With SearchMode::Graph, all threads share a concurrent closed list, so no state is expanded twice.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
     [[nodiscard]] std::shared_ptr<Node<State>> foreach_bfs(const Problem<State, TM> &problem) {
         auto init_node = std::make_shared<Node<State>>(problem.initial());
-        return detail::foreach_bfs_recursive(std::move(init_node), problem, std::stop_source{});
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+        return detail::foreach_bfs_recursive(std::move(init_node), problem, closed, std::stop_source{});
     }
 }
 
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <deque>
 #include "bfs.h"
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
@@ -18,22 +19,24 @@
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, foreach_bfs only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// With SearchMode::Graph, all threads share a concurrent closed list, so no state is expanded twice.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
     [[nodiscard]] std::shared_ptr<Node<State>> foreach_start_bfs(const Problem<State, TM> &problem) {
         std::deque<std::shared_ptr<Node<State>>> frontier({std::make_shared<Node<State>>(problem.initial())});
         unsigned int min_starting_points = std::thread::hardware_concurrency();
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
 
         // First fill the frontier with enough starting points
-        auto possible_solution = detail::bfs_with_limit(frontier, problem, min_starting_points);
+        auto possible_solution = detail::bfs_with_limit(frontier, problem, closed, min_starting_points);
         if (possible_solution != nullptr) return possible_solution;
 
         // Then start a parallel search from each starting point
         std::stop_source stop_source{};
         std::atomic<std::shared_ptr<Node<State>>> solution{nullptr};
 
-        std::for_each(std::execution::par, frontier.cbegin(), frontier.cend(), [&problem, stop_source, &solution](const auto &node) {
-            auto possible_solution = detail::interruptible_bfs(node, problem, stop_source);
+        std::for_each(std::execution::par, frontier.cbegin(), frontier.cend(), [&problem, &closed, stop_source, &solution](const auto &node) {
+            auto possible_solution = detail::interruptible_bfs(node, problem, closed, stop_source);
             if (possible_solution != nullptr) solution.store(possible_solution);
         });
 
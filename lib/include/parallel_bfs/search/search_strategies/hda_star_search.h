@@ -0,0 +1,191 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_HDA_STAR_SEARCH_H
+#define PARALLEL_BFS_PROJECT_HDA_STAR_SEARCH_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include "best_first_search.h"
+#include "../closed_list.h"
+#include "../priority_queue.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    template<Searchable State>
+    struct OpenEntry {
+        int f;
+        const ArenaNode<State> *node;
+    };
+
+
+    /// Lowest f first. Ties are broken in favour of the deepest node, which reaches the goals sooner.
+    template<Searchable State>
+    struct OpenEntryCompare {
+        bool operator()(const OpenEntry<State> &a, const OpenEntry<State> &b) const noexcept {
+            return a.f < b.f || (a.f == b.f && a.node->path_cost() > b.node->path_cost());
+        }
+    };
+
+
+    /// Multiple-producer, single-consumer message queue used to send nodes to the thread that owns them.
+    template<Searchable State>
+    class Mailbox {
+    public:
+        void send(std::vector<OpenEntry<State>> &messages) {
+            if (messages.empty()) return;
+            std::lock_guard lock{_mutex};
+            _messages.insert(_messages.end(), messages.cbegin(), messages.cend());
+            messages.clear();
+        }
+
+        /// Moves all the pending messages to @output (which is cleared first).
+        void receive(std::vector<OpenEntry<State>> &output) {
+            output.clear();
+            std::lock_guard lock{_mutex};
+            std::swap(output, _messages);
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<OpenEntry<State>> _messages{};
+    };
+
+
+    /**
+     * @brief Hash-Distributed A* (HDA*).
+     *
+     * Each state is owned by exactly one thread, chosen by hashing the state. Every thread runs A* on its own open list
+     * (and its own closed list in graph search), and the children it generates are sent to the mailbox of their owner.
+     * Since no data structure is shared except the mailboxes, duplicate detection does not need any synchronization.
+     *
+     * The first solution found is not necessarily optimal, so it is kept as an incumbent and the search goes on,
+     * pruning every node whose f is not lower than the incumbent cost. The search terminates when there are no
+     * pending nodes (neither in the open lists nor in flight), which is tracked with a global counter.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, Heuristic<State> H, SearchMode Mode>
+    class HdaStarSearch {
+    public:
+        /// Runs one search thread on each worker of @pool.
+        explicit HdaStarSearch(const Problem<State, TM> &problem, ThreadPool &pool)
+                : _problem{problem}, _pool{pool}, _num_threads{pool.size()}, _mailboxes(_num_threads), _arenas(_num_threads) {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            const ArenaNode<State> *root = _root_arena.make_node(_problem.initial());
+            std::vector<OpenEntry<State>> first_message{{_heuristic(root->state()), root}};
+            _pending.store(1);
+            _mailboxes[owner(root->state())].send(first_message);
+
+            _pool.run_on_all([this](unsigned int id) { run(id); });
+
+            return to_shared_node(_incumbent);
+        }
+
+    private:
+        [[nodiscard]] unsigned int owner(const State &state) const noexcept {
+            const auto hash = static_cast<std::uint64_t>(std::hash<State>{}(state)) * 0x9e3779b97f4a7c15ULL;
+            return static_cast<unsigned int>((hash >> 32) % _num_threads);
+        }
+
+        void run(unsigned int id) {
+            DaryHeap<OpenEntry<State>, OpenEntryCompare<State>> open;
+            best_cost_table_t<State, Mode> best;
+            std::vector<std::vector<OpenEntry<State>>> outgoing(_num_threads);
+            std::vector<OpenEntry<State>> inbox;
+
+            // Adds an entry owned by this thread to the open list, unless it can be discarded
+            auto accept = [this, &open, &best](const OpenEntry<State> &entry) {
+                if (entry.f < _incumbent_cost.load(std::memory_order_relaxed) && best.improve(entry.node->state(), entry.node->path_cost()))
+                    open.push(entry);
+                else
+                    _pending.fetch_sub(1, std::memory_order_acq_rel);
+            };
+
+            while (true) {
+                _mailboxes[id].receive(inbox);
+                for (const auto &entry: inbox) accept(entry);
+
+                if (open.empty()) {
+                    if (_pending.load(std::memory_order_acquire) == 0) break;
+                    const IdleScope idle;
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const OpenEntry<State> entry = open.pop();
+                const ArenaNode<State> *node = entry.node;
+                if (entry.f < _incumbent_cost.load(std::memory_order_relaxed) && !best.is_stale(node->state(), node->path_cost())) {
+                    if (_problem.is_goal(node->state())) {
+                        update_incumbent(node);
+                    } else {
+                        _problem.expand(node, _arenas[id], [this, id, &accept, &outgoing](const ArenaNode<State> *child) {
+                            OpenEntry<State> child_entry{child->path_cost() + _heuristic(child->state()), child};
+                            if (child_entry.f >= _incumbent_cost.load(std::memory_order_relaxed)) return;
+                            _pending.fetch_add(1, std::memory_order_acq_rel); // Before the parent is marked as done
+                            const unsigned int destination = owner(child->state());
+                            if (destination == id) accept(child_entry);
+                            else outgoing[destination].push_back(child_entry);
+                        });
+                        for (unsigned int i = 0; i < _num_threads; ++i) {
+                            count_handoffs(outgoing[i].size());
+                            _mailboxes[i].send(outgoing[i]);
+                        }
+                        record_frontier(open.size());
+                    }
+                }
+                _pending.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+
+        void update_incumbent(const ArenaNode<State> *node) {
+            std::lock_guard lock{_incumbent_mutex};
+            if (node->path_cost() < _incumbent_cost.load(std::memory_order_relaxed)) {
+                _incumbent = node;
+                _incumbent_cost.store(node->path_cost(), std::memory_order_relaxed);
+            }
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const unsigned int _num_threads;
+        const H _heuristic{};
+        std::vector<Mailbox<State>> _mailboxes;
+        std::vector<NodeArena<State>> _arenas; // One per thread, alive until the solution has been copied
+        NodeArena<State> _root_arena{1};
+        std::atomic<long long> _pending{0};
+        std::atomic<int> _incumbent_cost{std::numeric_limits<int>::max()};
+        std::mutex _incumbent_mutex;
+        const ArenaNode<State> *_incumbent{nullptr};
+    };
+}
+
+
+namespace parallel_bfs {
+    /// Parallel A* that distributes the states among threads by hashing them (HDA*). Returns an optimal solution.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, Heuristic<State> H = ZeroHeuristic<State>, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> hda_star_search(const Problem<State, TM> &problem, ThreadPool &pool) {
+        detail::HdaStarSearch<State, TM, H, Mode> search{problem, pool};
+        return search.search();
+    }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, Heuristic<State> H = ZeroHeuristic<State>, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> hda_star_search(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return hda_star_search<State, TM, H, Mode>(problem, pool);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_HDA_STAR_SEARCH_H
@@ -0,0 +1,219 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_IDDFS_H
+#define PARALLEL_BFS_PROJECT_IDDFS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <utility>
+#include <cstdint>
+#include "../problem.h"
+#include "../node.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    enum class DfsResult { Found, Cutoff, Exhausted };
+
+
+    /**
+     * @brief Depth-limited depth-first search that only goal-tests the nodes at the depth limit.
+     *
+     * Only the path from the root to the current node is stored, so it needs O(limit) memory. Successors are visited
+     * in the order in which the transition model generates them, so the goal found at depth d is the first one that
+     * a BFS would have found at that depth.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    class DepthLimitedSearch {
+    public:
+        explicit DepthLimitedSearch(const Problem<State, TM> &problem) : _problem{problem} {}
+
+        /**
+         * @brief Searches the nodes that are exactly @limit actions below @root.
+         *
+         * @param stop Called at every inner node. The search is abandoned (and returns Cutoff) once it returns true.
+         * @return Found if a goal was found (see path()), Cutoff if some node reached the limit (so there might be
+         * deeper nodes), and Exhausted if the whole subtree of @root is shallower than the limit.
+         */
+        template<std::predicate Stop>
+        [[nodiscard]] DfsResult run(const State &root, unsigned int limit, Stop &&stop) {
+            _path.clear();
+            _path.reserve(limit); // References to the elements of the path must stay valid during the search
+            _cutoff = false;
+            _stopped = false;
+            if (visit(root, limit, stop)) return DfsResult::Found;
+            return _cutoff || _stopped ? DfsResult::Cutoff : DfsResult::Exhausted;
+        }
+
+        /// States (and the cost of the action that reached them) from the root (excluded) to the goal of the last run.
+        [[nodiscard]] const std::vector<std::pair<State, int>> &path() const { return _path; }
+
+    private:
+        template<typename Stop>
+        bool visit(const State &state, unsigned int remaining, Stop &stop) {
+            if (remaining == 0) {
+                record_frontier(_path.size()); // The frontier of DFS is the current path
+                _cutoff = true;
+                return _problem.is_goal(state);
+            }
+            if (stop()) {
+                _stopped = true;
+                return false;
+            }
+
+            bool found = false;
+            count_expansion();
+            _problem.for_each_successor(state, [this, remaining, &stop, &found](State &&next, int cost) {
+                if (found || _stopped) return;
+                _path.emplace_back(std::move(next), cost);
+                if (visit(_path.back().first, remaining - 1, stop)) found = true;
+                else _path.pop_back();
+            });
+            return found;
+        }
+
+        const Problem<State, TM> &_problem;
+        std::vector<std::pair<State, int>> _path{};
+        bool _cutoff{false};
+        bool _stopped{false};
+    };
+
+
+    /// Appends @path to @root. @path is a path found by DepthLimitedSearch below the state of @root.
+    template<Searchable State>
+    [[nodiscard]] std::shared_ptr<Node<State>> extend_path(std::shared_ptr<Node<State>> root, const std::vector<std::pair<State, int>> &path) {
+        for (const auto &[state, cost]: path) root = std::make_shared<Node<State>>(state, root, root->path_cost() + cost);
+        return root;
+    }
+
+
+    /**
+     * @brief Parallel iterative deepening DFS.
+     *
+     * The first levels of the tree are expanded with BFS until there are enough subtrees to balance the load. Then, the
+     * work items are (depth limit, subtree) pairs, handed out in increasing order of depth and then subtree with a
+     * shared counter, so threads deepen different subtrees without waiting for each other at the end of every
+     * iteration. The lowest item that finds a goal is kept in an atomic bound: items above it are never started, and
+     * the ones in progress are abandoned, while the items below it are always finished. Therefore, the result is the
+     * shallowest goal of the lowest subtree, which is the goal that sync_bfs finds.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    class IterativeDeepeningSearch {
+    public:
+        /// Runs one search thread on each worker of @pool.
+        explicit IterativeDeepeningSearch(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t subtrees_per_thread = 16)
+                : _problem{problem}, _pool{pool}, _min_subtrees{subtrees_per_thread * pool.size()} {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            if (auto goal = split()) return goal;
+            if (_roots.empty()) return nullptr;
+
+            _exhausted = std::vector<std::atomic<bool>>(_roots.size());
+            _pool.run_on_all([this]([[maybe_unused]] unsigned int id) { run(); });
+
+            if (_bound.load(std::memory_order_relaxed) == no_solution) return nullptr;
+            return extend_path(_roots[_solution_root], _solution_path);
+        }
+
+    private:
+        static constexpr std::uint64_t no_solution = std::numeric_limits<std::uint64_t>::max();
+
+        /// Expands the first levels of the tree with BFS, goal-testing their nodes. Returns the first goal, if any.
+        [[nodiscard]] std::shared_ptr<Node<State>> split() {
+            auto root = std::make_shared<Node<State>>(_problem.initial());
+            if (_problem.is_goal(root->state())) return root;
+            _roots.push_back(std::move(root));
+
+            while (!_roots.empty() && _roots.size() < _min_subtrees) {
+                std::vector<std::shared_ptr<Node<State>>> next;
+                for (const auto &node: _roots) {
+                    _problem.expand(node, [&next](std::shared_ptr<Node<State>> &&child) { next.push_back(std::move(child)); });
+                }
+                for (const auto &node: next)
+                    if (_problem.is_goal(node->state())) return node;
+                _roots = std::move(next);
+                record_frontier(_roots.size());
+            }
+            return nullptr;
+        }
+
+        void run() {
+            DepthLimitedSearch<State, TM> dfs{_problem};
+            const std::uint64_t num_roots = _roots.size();
+
+            while (_num_exhausted.load(std::memory_order_relaxed) < num_roots) {
+                const std::uint64_t item = _next_item.fetch_add(1, std::memory_order_relaxed);
+                const std::uint64_t depth = item / num_roots + 1, root = item % num_roots;
+                const std::uint64_t key = depth << 32 | root; // Items are handed out in increasing order of key
+                if (key > _bound.load(std::memory_order_relaxed) || depth > std::numeric_limits<std::uint32_t>::max()) return;
+                if (_exhausted[root].load(std::memory_order_relaxed)) continue;
+
+                const auto result = dfs.run(_roots[root]->state(), static_cast<unsigned int>(depth), [this, key] {
+                    return _bound.load(std::memory_order_relaxed) < key;
+                });
+                if (result == DfsResult::Found) {
+                    std::lock_guard lock{_solution_mutex};
+                    if (key < _bound.load(std::memory_order_relaxed)) {
+                        _solution_root = static_cast<std::size_t>(root);
+                        _solution_path = dfs.path();
+                        _bound.store(key, std::memory_order_relaxed);
+                        note_stop_request();
+                    }
+                } else if (result == DfsResult::Exhausted && !_exhausted[root].exchange(true, std::memory_order_relaxed)) {
+                    _num_exhausted.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const std::size_t _min_subtrees;
+        std::vector<std::shared_ptr<Node<State>>> _roots{}; // Subtrees of the parallel phase, all at the same depth
+        std::vector<std::atomic<bool>> _exhausted{}; // Subtrees without nodes at the current depth limit
+        std::atomic<std::uint64_t> _num_exhausted{0};
+        std::atomic<std::uint64_t> _next_item{0};
+        std::atomic<std::uint64_t> _bound{no_solution}; // Lowest key (depth << 32 | subtree) that found a goal
+        std::mutex _solution_mutex;
+        std::size_t _solution_root{0};
+        std::vector<std::pair<State, int>> _solution_path{};
+    };
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Iterative deepening DFS: depth-limited DFS with limits 0, 1, 2... until a goal is found.
+     *
+     * It returns the same solution as sync_bfs, but it only stores the current path, so its memory is O(depth) instead
+     * of O(b^depth). The price is that shallow nodes are generated again in every iteration (about b/(b-1) times more
+     * expansions). Like any tree-like search, it does not detect repeated states. If there is no solution, the last
+     * iteration only finds out that the tree has no nodes at the limit.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    [[nodiscard]] std::shared_ptr<Node<State>> iddfs(const Problem<State, TM> &problem) {
+        detail::DepthLimitedSearch<State, TM> dfs{problem};
+        for (unsigned int limit = 0;; ++limit) {
+            const auto result = dfs.run(problem.initial(), limit, [] { return false; });
+            if (result == detail::DfsResult::Found) return detail::extend_path(std::make_shared<Node<State>>(problem.initial()), dfs.path());
+            if (result == detail::DfsResult::Exhausted) return nullptr;
+        }
+    }
+
+
+    /// Parallel version of iddfs(), with O(depth) memory per worker of @pool (plus the first levels of the tree).
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    [[nodiscard]] std::shared_ptr<Node<State>> iddfs(const Problem<State, TM> &problem, ThreadPool &pool) {
+        detail::IterativeDeepeningSearch<State, TM> search{problem, pool};
+        return search.search();
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_IDDFS_H
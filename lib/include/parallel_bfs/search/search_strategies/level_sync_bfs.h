@@ -0,0 +1,185 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_LEVEL_SYNC_BFS_H
+#define PARALLEL_BFS_PROJECT_LEVEL_SYNC_BFS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <barrier>
+#include <exception>
+#include <limits>
+#include <algorithm>
+#include <span>
+#include <bit>
+#include <cstdint>
+#include "../closed_list.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief Level-synchronous parallel BFS.
+     *
+     * The frontier is processed one depth level at a time, in two phases separated by barriers:
+     *  1. Expansion: the current level is split into contiguous chunks, one per thread, and each thread appends the
+     *     children of its chunk to its own output buffer.
+     *  2. Concatenation and goal test: the offset of each buffer in the next level is computed with a prefix sum of
+     *     their sizes, and each thread copies its buffer to its offset and goal-tests the nodes that it copied, in
+     *     batches (see Problem::goal_mask).
+     *
+     * The search stops at the first level that contains a goal, so the solution is always a shallowest one. Since the
+     * next level keeps the order in which a sequential BFS would have generated it, the goal with the lowest index is
+     * returned and (in tree search) the result is the same as the one of sync_bfs.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode>
+    class LevelSyncSearch {
+    public:
+        /// Runs one search thread on each worker of @pool.
+        explicit LevelSyncSearch(const Problem<State, TM> &problem, ThreadPool &pool)
+                : _problem{problem}, _pool{pool}, _num_threads{pool.size()}, _buffers(_num_threads), _offsets(_num_threads + 1), _arenas(_num_threads) {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            const ArenaNode<State> *root = _root_arena.make_node(_problem.initial());
+            if (_problem.is_goal(root->state())) return to_shared_node(root);
+            _closed.insert(root->state());
+            _level.push_back(root);
+
+            std::barrier sync_point{static_cast<std::ptrdiff_t>(_num_threads), PhaseCompletion{this}};
+            _pool.run_on_all([this, &sync_point](unsigned int id) { run(id, sync_point); });
+            if (_error) std::rethrow_exception(_error);
+
+            return _solution_index == no_solution ? nullptr : to_shared_node(_level[_solution_index]);
+        }
+
+    private:
+        static constexpr std::size_t no_solution = std::numeric_limits<std::size_t>::max();
+        static constexpr auto node_state = [](const ArenaNode<State> *node) -> const State & { return node->state(); };
+
+        /// Runs on a single thread after all threads have arrived at the barrier.
+        struct PhaseCompletion {
+            LevelSyncSearch *self;
+
+            void operator()() noexcept { self->end_phase(); }
+        };
+
+        template<typename Barrier>
+        void run(unsigned int id, Barrier &sync_point) {
+            std::vector<const ArenaNode<State> *> &buffer = _buffers[id];
+            while (!_finished) {
+                // Phase 1: expand my chunk of the current level
+                const auto [begin, end] = chunk(_level.size(), id);
+                for (std::size_t i = begin; i < end; ++i) {
+                    _problem.expand(_level[i], _arenas[id], [this, &buffer](const ArenaNode<State> *child) {
+                        if (_closed.insert(child->state())) buffer.push_back(child);
+                    });
+                }
+                wait_for_all(sync_point);
+                if (_error) return; // The next level could not be allocated (see end_phase)
+
+                // Phase 2: copy my buffer to the next level and goal-test its nodes in batches
+                const std::size_t offset = _offsets[id];
+                std::ranges::copy(buffer, _next_level.begin() + static_cast<std::ptrdiff_t>(offset));
+                std::size_t local_solution = no_solution;
+                // Stop as well when another thread has found a goal that comes before the rest of my buffer
+                for (std::size_t i = 0; i < buffer.size() && _solution.load(std::memory_order_relaxed) > offset + i; i += Problem<State, TM>::goal_batch_size) {
+                    const std::size_t batch = std::min(buffer.size() - i, Problem<State, TM>::goal_batch_size);
+                    const std::uint64_t goals = _problem.goal_mask(std::span{buffer}.subspan(i, batch), node_state);
+                    if (goals != 0) {
+                        local_solution = offset + i + static_cast<std::size_t>(std::countr_zero(goals));
+                        break;
+                    }
+                }
+                buffer.clear();
+                if (local_solution != no_solution) update_solution(local_solution);
+                wait_for_all(sync_point);
+            }
+        }
+
+        template<typename Barrier>
+        static void wait_for_all(Barrier &sync_point) {
+            const IdleScope idle;
+            sync_point.arrive_and_wait();
+        }
+
+        void end_phase() noexcept {
+            if (!_expanded) { // End of phase 1: prefix sum of the buffer sizes
+                _offsets[0] = 0;
+                for (unsigned int i = 0; i < _num_threads; ++i) _offsets[i + 1] = _offsets[i] + _buffers[i].size();
+                try {
+                    _next_level.resize(_offsets[_num_threads]);
+                } catch (...) { // The completion of a barrier must not throw: search() rethrows it instead
+                    _error = std::current_exception();
+                    _finished = true;
+                }
+                _expanded = true;
+                return;
+            }
+
+            // End of phase 2: move to the next level
+            _expanded = false;
+            std::swap(_level, _next_level);
+            _next_level.clear();
+            record_frontier(_level.size());
+            _solution_index = _solution.load(std::memory_order_relaxed);
+            _finished = _solution_index != no_solution || _level.empty();
+        }
+
+        void update_solution(std::size_t index) noexcept {
+            note_stop_request();
+            std::size_t current = _solution.load(std::memory_order_relaxed);
+            while (index < current && !_solution.compare_exchange_weak(current, index, std::memory_order_relaxed));
+        }
+
+        /// Contiguous range of the level assigned to thread @id. Chunk sizes differ by at most one node.
+        [[nodiscard]] std::pair<std::size_t, std::size_t> chunk(std::size_t size, unsigned int id) const noexcept {
+            const std::size_t base = size / _num_threads, extra = size % _num_threads;
+            const std::size_t begin = id * base + std::min<std::size_t>(id, extra);
+            return {begin, begin + base + (id < extra ? 1 : 0)};
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const unsigned int _num_threads;
+        std::vector<const ArenaNode<State> *> _level{};
+        std::vector<const ArenaNode<State> *> _next_level{};
+        std::vector<std::vector<const ArenaNode<State> *>> _buffers; // One output buffer per thread
+        std::vector<std::size_t> _offsets;
+        std::vector<NodeArena<State>> _arenas; // One per thread, alive until the solution has been copied
+        NodeArena<State> _root_arena{1};
+        concurrent_closed_list_t<State, Mode> _closed{};
+        std::atomic<std::size_t> _solution{no_solution}; // Lowest index of a goal in the next level
+        std::size_t _solution_index{no_solution};
+        bool _expanded{false}; // Only accessed by the barrier completion
+        bool _finished{false}; // Written by the barrier completion, read by all threads after the barrier
+        std::exception_ptr _error{nullptr}; // Same as _finished
+    };
+}
+
+
+namespace parallel_bfs {
+    /// Parallel BFS that expands the frontier one level at a time, so it always returns a shallowest solution.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> level_sync_bfs(const Problem<State, TM> &problem, ThreadPool &pool) {
+        detail::LevelSyncSearch<State, TM, Mode> search{problem, pool};
+        return search.search();
+    }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> level_sync_bfs(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return level_sync_bfs<State, TM, Mode>(problem, pool);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_LEVEL_SYNC_BFS_H
@@ -12,10 +12,13 @@
 #include <mutex>
 #include <condition_variable>
 #include <future>
+#include <algorithm>
 #include "bfs.h"
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
+#include "../thread_pool.h"
 #include "../transition_model.h"
 
 
@@ -23,6 +26,7 @@ namespace parallel_bfs::detail {
     class SearchStatusController {
     public:
         void signal_solution_found() {
+            note_stop_request();
             ssource_solution_found.request_stop();
             ssource_search_finished.request_stop();
         }
@@ -42,13 +46,15 @@ namespace parallel_bfs::detail {
     };
 
 
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode>
     class Worker {
     public:
-        std::future<std::shared_ptr<Node<State>>> start_search(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, SearchStatusController status_controller) {
+        using closed_list_type = concurrent_closed_list_t<State, Mode>;
+
+        std::future<std::shared_ptr<Node<State>>> start_search(std::shared_ptr<Node<State>> init_node, const Problem<State, TM> &problem, SearchStatusController status_controller, closed_list_type &closed, ThreadPool &pool) {
             frontier.push_back(std::move(init_node));
             status = std::move(status_controller);
-            return std::async(std::launch::async, [this, &problem] { return search(problem); });
+            return pool.submit([this, &problem, &closed] { return search(problem, closed); });
         }
 
         /**
@@ -73,15 +79,22 @@ namespace parallel_bfs::detail {
         }
 
     private:
-        std::shared_ptr<Node<State>> search(const Problem<State, TM> &problem) {
+        std::shared_ptr<Node<State>> search(const Problem<State, TM> &problem, closed_list_type &closed) {
             while (!status.solution_found()) {
                 std::unique_lock lock{mutex};
                 if (frontier.empty() && status.search_finished()) break;
-                condition.wait(lock, status.get_search_token(), [this] { return !frontier.empty(); });
-                auto solution = interruptible_bfs(frontier, problem, status.ssource_solution_found);
+                {
+                    const IdleScope waiting; // For the director to hand out work
+                    condition.wait(lock, status.get_search_token(), [this] { return !frontier.empty(); });
+                }
+                if (frontier.empty()) continue; // Woken up by the end of the search
+                trace_instant("work received", frontier.size());
+                const TraceScope trace{"bfs", frontier.size()};
+                auto solution = interruptible_bfs(frontier, problem, closed, status.ssource_solution_found);
                 if (solution != nullptr) return solution;
                 // Release lock with its destructor
             }
+            if (status.solution_found()) trace_instant("stop observed");
             return nullptr;
         }
 
@@ -93,15 +106,17 @@ namespace parallel_bfs::detail {
 
 
 
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode>
     class ThreadDirector {
     public:
-        explicit ThreadDirector(unsigned int num_threads, unsigned int min_starting_points)
-                : num_threads{num_threads}, min_starting_points{min_starting_points}, workers(num_threads) {}
+        /// One worker per thread of @pool. The director runs on the calling thread.
+        explicit ThreadDirector(ThreadPool &pool, unsigned int min_starting_points)
+                : pool{pool}, num_threads{pool.size()}, min_starting_points{min_starting_points}, workers(num_threads) {}
 
         [[nodiscard]] std::shared_ptr<Node<State>> search(const Problem<State, TM> &problem) {
             // First create enough initial work
             main_frontier.push_back(std::make_shared<Node<State>>(problem.initial()));
+            closed.insert(problem.initial());
             generate_work(problem, min_starting_points);
             if (status.solution_found() || main_frontier.empty()) return solution;
 
@@ -118,6 +133,7 @@ namespace parallel_bfs::detail {
             status.signal_search_finished();
 
             // Ensure that all threads have finished to avoid data races
+            const IdleScope waiting;
             for (auto &future: futures)
                 if (auto result = future.get(); result != nullptr) solution = result;
             return solution;
@@ -125,7 +141,7 @@ namespace parallel_bfs::detail {
 
         void generate_work(const Problem<State, TM> &problem, unsigned int new_childs_count) {
             std::size_t limit = main_frontier.size() + new_childs_count;
-            auto possible_solution = detail::bfs_with_limit(main_frontier, problem, limit);
+            auto possible_solution = detail::bfs_with_limit(main_frontier, problem, closed, limit);
             if (possible_solution != nullptr) {
                 status.signal_solution_found();
                 solution = possible_solution;
@@ -135,14 +151,18 @@ namespace parallel_bfs::detail {
         void distribute_work() {
             for (unsigned int i = 0; i < num_threads; ++i) {
                 if (main_frontier.empty() || status.solution_found()) break;
-                if (workers[i].add_work_if_needed(main_frontier.front())) main_frontier.pop_front();
+                if (workers[i].add_work_if_needed(main_frontier.front())) {
+                    main_frontier.pop_front();
+                    count_handoffs();
+                    trace_instant("work sent", i);
+                }
             }
         }
 
         std::vector<std::future<std::shared_ptr<Node<State>>>> start_workers(const Problem<State, TM> &problem) {
             std::vector<std::future<std::shared_ptr<Node<State>>>> futures(num_threads);
             for (unsigned int i = 0; i < num_threads; ++i) {
-                futures[i] = workers[i].start_search(main_frontier.front(), problem, status);
+                futures[i] = workers[i].start_search(main_frontier.front(), problem, status, closed, pool);
                 main_frontier.pop_front();
             }
             return futures;
@@ -150,10 +170,12 @@ namespace parallel_bfs::detail {
 
 
     private:
+        ThreadPool &pool;
         const unsigned int num_threads;
         const unsigned int min_starting_points;
-        std::vector<Worker<State, TM>> workers;
+        std::vector<Worker<State, TM, Mode>> workers;
         std::deque<std::shared_ptr<Node<State>>> main_frontier{};
+        typename Worker<State, TM, Mode>::closed_list_type closed{}; // Shared by the director and all the workers
         SearchStatusController status;
         std::shared_ptr<Node<State>> solution{nullptr};
     };
@@ -161,11 +183,20 @@ namespace parallel_bfs::detail {
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, ParallelBFSTasks only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
-    [[nodiscard]] std::shared_ptr<Node<State>> multithread_bfs(const Problem<State, TM> &problem) {
-        detail::ThreadDirector<State, TM> director{std::thread::hardware_concurrency(), std::thread::hardware_concurrency() * 4};
+    /// The workers run on @pool. With SearchMode::Graph, the director and the workers share a concurrent closed list.
+    /// The director creates @starting_points_per_thread nodes per worker before starting them.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> multithread_bfs(const Problem<State, TM> &problem, ThreadPool &pool, unsigned int starting_points_per_thread = 4) {
+        detail::ThreadDirector<State, TM, Mode> director{pool, pool.size() * std::max(starting_points_per_thread, 1u)};
         return director.search(problem);
     }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> multithread_bfs(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return multithread_bfs<State, TM, Mode>(problem, pool);
+    }
 }
 #endif //PARALLEL_BFS_MULTITHREAD_BFS_H
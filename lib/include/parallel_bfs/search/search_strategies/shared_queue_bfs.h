@@ -0,0 +1,146 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_SHARED_QUEUE_BFS_H
+#define PARALLEL_BFS_PROJECT_SHARED_QUEUE_BFS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <span>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <stop_token>
+#include "arena_bfs.h"
+#include "../mpmc_queue.h"
+#include "../closed_list.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief BFS where all threads share a single global frontier.
+     *
+     * Threads repeatedly take a batch of nodes from the front of the queue, goal-test them at once, and push all their
+     * children at the back, so the order of expansion stays close to that of a sequential BFS and no thread ever runs
+     * out of work while the frontier is not empty. If the queue is full, the children that do not fit are kept in a
+     * private overflow frontier, which the thread expands once the queue has no nodes for it.
+     *
+     * Termination: a shared counter holds the number of nodes that have been generated but not expanded yet. Each
+     * batch adds its children before publishing them and subtracts itself, so the counter only reaches zero when no
+     * node is left in any queue.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode, BulkQueue<const ArenaNode<State> *> Queue>
+    class SharedQueueSearch {
+    public:
+        /// Runs one search thread on each worker of @pool.
+        template<typename... QueueArgs>
+        explicit SharedQueueSearch(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t batch_size, QueueArgs &&... queue_args)
+                : _problem{problem}, _pool{pool}, _batch_size{std::clamp<std::size_t>(batch_size, 1, Problem<State, TM>::goal_batch_size)},
+                  _arenas(pool.size()), _queue{std::forward<QueueArgs>(queue_args)...} {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            _closed.insert(_problem.initial());
+            const ArenaNode<State> *root = _root_arena.make_node(_problem.initial());
+            _pending.store(1, std::memory_order_relaxed);
+            _queue.push_bulk(std::span{&root, 1});
+
+            _pool.run_on_all([this](unsigned int id) { run(id); });
+
+            return to_shared_node(_solution.load(std::memory_order_acquire));
+        }
+
+    private:
+        void run(unsigned int id) {
+            NodeArena<State> &arena = _arenas[id];
+            std::vector<const ArenaNode<State> *> batch(_batch_size), children;
+            ArenaFrontier<State> overflow;
+            auto node_state = [](const ArenaNode<State> *node) -> const State & { return node->state(); };
+
+            while (!_stop.stop_requested()) {
+                std::size_t count = _queue.pop_bulk(std::span{batch});
+                for (; count < _batch_size && !overflow.empty(); ++count) {
+                    batch[count] = overflow.front();
+                    overflow.pop_front();
+                }
+                if (count == 0) {
+                    if (_pending.load(std::memory_order_acquire) == 0) return; // The search space has been exhausted
+                    const IdleScope idle;
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const std::span<const ArenaNode<State> *const> nodes{batch.data(), count};
+                if (const std::uint64_t goals = _problem.goal_mask(nodes, node_state, _stop.get_token()); goals != 0) {
+                    const ArenaNode<State> *expected = nullptr;
+                    _solution.compare_exchange_strong(expected, nodes[std::countr_zero(goals)], std::memory_order_acq_rel);
+                    note_stop_request();
+                    _stop.request_stop();
+                    return;
+                }
+
+                if (_stop.stop_requested()) break; // Some nodes may not have been tested
+
+                children.clear();
+                for (const ArenaNode<State> *node: nodes) {
+                    _problem.expand(node, arena, [this, &children](const ArenaNode<State> *child) {
+                        if (_closed.insert(child->state())) children.push_back(child);
+                    });
+                }
+
+                // Count the children before other threads can see (and finish) them
+                const std::int64_t added = static_cast<std::int64_t>(children.size()) - static_cast<std::int64_t>(count);
+                record_frontier(static_cast<std::uint64_t>(_pending.fetch_add(added, std::memory_order_acq_rel) + added)); // The shared frontier
+                const std::size_t pushed = _queue.push_bulk(std::span<const ArenaNode<State> *const>{children});
+                overflow.insert(overflow.end(), children.begin() + static_cast<std::ptrdiff_t>(pushed), children.end());
+            }
+            trace_instant("stop observed");
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const std::size_t _batch_size;
+        std::vector<NodeArena<State>> _arenas; // Must outlive the threads and the final path copy
+        NodeArena<State> _root_arena{1};
+        concurrent_closed_list_t<State, Mode> _closed{};
+        Queue _queue;
+        std::stop_source _stop{};
+        alignas(64) std::atomic<std::int64_t> _pending{0};
+        std::atomic<const ArenaNode<State> *> _solution{nullptr};
+    };
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Parallel BFS with a single frontier shared by all threads (see detail::SharedQueueSearch).
+     *
+     * The frontier is a lock-free bounded queue of @queue_capacity nodes. Nodes are moved in and out of it in batches
+     * of @batch_size, so there is at most one contended operation per batch. With SearchMode::Graph, all threads
+     * share a concurrent closed list.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>>
+    shared_queue_bfs(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t batch_size = 32, std::size_t queue_capacity = 1 << 16) {
+        detail::SharedQueueSearch<State, TM, Mode, detail::MpmcQueue<const ArenaNode<State> *>> search{problem, pool, batch_size, queue_capacity};
+        return search.search();
+    }
+
+
+    /// Same as shared_queue_bfs, but the frontier is an unbounded queue protected by a mutex.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> locked_queue_bfs(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t batch_size = 32) {
+        detail::SharedQueueSearch<State, TM, Mode, detail::LockedQueue<const ArenaNode<State> *>> search{problem, pool, batch_size};
+        return search.search();
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_SHARED_QUEUE_BFS_H
@@ -7,6 +7,7 @@
 
 #include <queue>
 #include "bfs.h"
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
@@ -14,9 +15,12 @@
 
 
 namespace parallel_bfs {
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
+    /// With SearchMode::Graph, repeated states are detected with a sequential closed list.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
     [[nodiscard]] std::shared_ptr<Node<State>> sync_bfs(const Problem<State, TM> &problem) {
-        return detail::interruptible_bfs<State, TM>(std::make_shared<Node<State>>(problem.initial()), problem);
+        detail::closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
+        return detail::interruptible_bfs<State, TM>(std::make_shared<Node<State>>(problem.initial()), problem, closed);
     }
 }
 
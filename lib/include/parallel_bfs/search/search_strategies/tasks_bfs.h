@@ -10,31 +10,37 @@
 #include <future>
 #include <thread>
 #include <queue>
+#include <algorithm>
 #include "bfs.h"
+#include "../closed_list.h"
 #include "../problem.h"
 #include "../node.h"
 #include "../state.h"
+#include "../thread_pool.h"
 #include "../transition_model.h"
 
 
 namespace parallel_bfs {
-    /// In order to avoid data races, ParallelBFSTasks only works with tree-like search.
-    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM>
-    [[nodiscard]] std::shared_ptr<Node<State>> tasks_bfs(const Problem<State, TM> &problem) {
+    /// Runs the search on the workers of @pool. With SearchMode::Graph, all threads share a concurrent closed list, so
+    /// no state is expanded twice. The first levels are searched sequentially until there are @starting_points_per_thread
+    /// nodes per worker: more starting points balance the work better, but take longer to generate.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> tasks_bfs(const Problem<State, TM> &problem, ThreadPool &pool, unsigned int starting_points_per_thread = 4) {
         std::deque<std::shared_ptr<Node<State>>> frontier{std::make_shared<Node<State>>(problem.initial())};
-        unsigned int min_starting_points = std::thread::hardware_concurrency() * 4;
+        unsigned int min_starting_points = pool.size() * std::max(starting_points_per_thread, 1u);
+        detail::concurrent_closed_list_t<State, Mode> closed;
+        closed.insert(problem.initial());
 
         // First fill the frontier with enough starting points
-        auto possible_solution = detail::bfs_with_limit(frontier, problem, min_starting_points);
+        auto possible_solution = detail::bfs_with_limit(frontier, problem, closed, min_starting_points);
         if (possible_solution != nullptr) return possible_solution;
 
         // Then start a parallel search from each starting point
-        std::vector<std::jthread> threads(std::thread::hardware_concurrency()); // FIXME: Pass the number of threads as a parameter
         std::vector<std::future<std::shared_ptr<Node<State>>>> futures;
         std::stop_source stop_source{};
 
         // Split the frontier into as many subfrontiers as threads
-        std::vector<std::deque<std::shared_ptr<Node<State>>> > subfrontiers(threads.size());
+        std::vector<std::deque<std::shared_ptr<Node<State>>> > subfrontiers(pool.size());
         while (!frontier.empty()) {
             for (std::size_t i = 0; i < subfrontiers.size() && !frontier.empty(); ++i) {
                 subfrontiers[i].push_back(frontier.front());
@@ -43,18 +49,25 @@ namespace parallel_bfs {
         }
 
         // Launch a task for each subfrontier
-        for (std::size_t i = 0; i < threads.size(); ++i) {
-            std::packaged_task task{[&problem, stop_source](std::deque<std::shared_ptr<Node<State>>> &subfrontier) {
-                return detail::interruptible_bfs(subfrontier, problem, stop_source);
-            }};
-            futures.push_back(task.get_future());
-            threads[i] = std::jthread(std::move(task), std::ref(subfrontiers[i]));
+        for (auto &subfrontier: subfrontiers) {
+            futures.push_back(pool.submit([&problem, &closed, &subfrontier, stop_source] {
+                return detail::interruptible_bfs(subfrontier, problem, closed, stop_source);
+            }));
         }
 
         std::shared_ptr<Node<State>> solution{nullptr};
+        const detail::IdleScope waiting;
         for (auto &future: futures) // Ensure that all threads have finished to avoid data races
             if (auto result = future.get(); result != nullptr) solution = result;
         return solution;
     }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> tasks_bfs(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return tasks_bfs<State, TM, Mode>(problem, pool);
+    }
 }
 #endif //PARALLEL_BFS_TASKS_BFS_H
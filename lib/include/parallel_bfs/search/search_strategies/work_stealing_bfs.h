@@ -0,0 +1,162 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_PROJECT_WORK_STEALING_BFS_H
+#define PARALLEL_BFS_PROJECT_WORK_STEALING_BFS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <stop_token>
+#include "arena_bfs.h"
+#include "../chase_lev_deque.h"
+#include "../closed_list.h"
+#include "../problem.h"
+#include "../node.h"
+#include "../node_arena.h"
+#include "../state.h"
+#include "../thread_pool.h"
+#include "../transition_model.h"
+
+
+namespace parallel_bfs::detail {
+    /**
+     * @brief BFS with per-thread work-stealing deques and no central director.
+     *
+     * Each thread runs BFS on a private FIFO frontier and keeps its shallowest nodes (the ones with the largest
+     * subtrees) published in a Chase-Lev deque, topped up to @publish_size after every expansion. Threads without work
+     * first take back their own published nodes and then steal from random victims, so the work is rebalanced for as
+     * long as the search lasts. Victims in the same NUMA node as the thief are tried first, since their nodes (and
+     * the subtrees expanded from them) are in local memory.
+     *
+     * Termination: a thread is idle when its frontier and its deque are empty, and it must leave the idle state
+     * before attempting a steal. Idle threads never push work, so once every thread is idle all the deques are empty
+     * and no node is in flight, which means that the search space has been exhausted.
+     */
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode>
+    class WorkStealingSearch {
+    public:
+        /// Runs one search thread on each worker of @pool.
+        explicit WorkStealingSearch(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t publish_size = 4)
+                : _problem{problem}, _pool{pool}, _num_threads{pool.size()}, _publish_size{publish_size > 0 ? publish_size : 1}, _workers(_num_threads) {}
+
+        [[nodiscard]] std::shared_ptr<Node<State>> search() {
+            _closed.insert(_problem.initial());
+            _workers[0].deque.push(_root_arena.make_node(_problem.initial()));
+
+            _pool.run_on_all([this](unsigned int id) { run(id); });
+
+            return to_shared_node(_solution.load(std::memory_order_acquire));
+        }
+
+    private:
+        struct alignas(64) WorkerState {
+            ChaseLevDeque<const ArenaNode<State> *> deque{};
+            NodeArena<State> arena{};
+            std::atomic<unsigned int> numa_node{0}; // Node of the thread that runs this worker
+        };
+
+        void run(unsigned int id) {
+            WorkerState &self = _workers[id];
+            self.numa_node.store(ThreadPool::current_node(), std::memory_order_relaxed);
+            ArenaFrontier<State> frontier;
+            std::minstd_rand rng{id + 1};
+
+            while (!_stop.stop_requested()) {
+                const ArenaNode<State> *node = nullptr;
+                if (!frontier.empty()) {
+                    node = frontier.front();
+                    frontier.pop_front();
+                } else if (auto own = self.deque.pop()) {
+                    node = *own;
+                } else if (node = find_work(id, rng); node == nullptr) {
+                    return; // The search has finished
+                }
+
+                if (_problem.is_goal(node->state())) {
+                    const ArenaNode<State> *expected = nullptr;
+                    _solution.compare_exchange_strong(expected, node, std::memory_order_acq_rel);
+                    note_stop_request();
+                    _stop.request_stop();
+                    return;
+                }
+                _problem.expand(node, self.arena, [this, &frontier](const ArenaNode<State> *child) {
+                    if (_closed.insert(child->state())) frontier.push_back(child);
+                });
+
+                // Keep some of the shallowest nodes available to other threads
+                while (self.deque.size() < _publish_size && frontier.size() > 1) {
+                    self.deque.push(frontier.front());
+                    frontier.pop_front();
+                }
+                record_frontier(frontier.size() + self.deque.size());
+            }
+            trace_instant("stop observed");
+        }
+
+        /// Steals a node from a random victim, trying the ones in the same NUMA node first. Returns nullptr if the
+        /// search has finished.
+        const ArenaNode<State> *find_work(unsigned int id, std::minstd_rand &rng) {
+            const IdleScope idle;
+            const unsigned int node = _workers[id].numa_node.load(std::memory_order_relaxed);
+            _idle.fetch_add(1, std::memory_order_seq_cst);
+            while (!_stop.stop_requested()) {
+                if (_idle.load(std::memory_order_seq_cst) == _num_threads) return nullptr;
+
+                const unsigned int start = static_cast<unsigned int>(rng());
+                for (const bool local: {true, false}) {
+                    for (unsigned int i = 0; i < _num_threads; ++i) {
+                        const unsigned int victim = (start + i) % _num_threads;
+                        if (victim == id || _workers[victim].deque.empty()) continue;
+                        if ((_workers[victim].numa_node.load(std::memory_order_relaxed) == node) != local) continue;
+
+                        _idle.fetch_sub(1, std::memory_order_seq_cst); // Active while holding a stolen node
+                        if (auto stolen = _workers[victim].deque.steal()) {
+                            count_handoffs();
+                            trace_instant("steal", victim);
+                            return *stolen;
+                        }
+                        _idle.fetch_add(1, std::memory_order_seq_cst);
+                    }
+                }
+                std::this_thread::yield();
+            }
+            return nullptr;
+        }
+
+        const Problem<State, TM> &_problem;
+        ThreadPool &_pool;
+        const unsigned int _num_threads;
+        const std::size_t _publish_size;
+        std::vector<WorkerState> _workers; // Arenas must outlive the threads and the final path copy
+        NodeArena<State> _root_arena{1};
+        concurrent_closed_list_t<State, Mode> _closed{};
+        std::stop_source _stop{};
+        alignas(64) std::atomic<unsigned int> _idle{0};
+        std::atomic<const ArenaNode<State> *> _solution{nullptr};
+    };
+}
+
+
+namespace parallel_bfs {
+    /// Parallel BFS where idle threads steal work from random victims. Each thread keeps @publish_size nodes in its
+    /// deque for the others to steal. With SearchMode::Graph, all threads share a concurrent closed list.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> work_stealing_bfs(const Problem<State, TM> &problem, ThreadPool &pool, std::size_t publish_size = 4) {
+        detail::WorkStealingSearch<State, TM, Mode> search{problem, pool, publish_size};
+        return search.search();
+    }
+
+
+    /// Same as above, but with a pool of std::thread::hardware_concurrency() threads created for this search only.
+    template<Searchable State, std::derived_from<BaseTransitionModel<State>> TM, SearchMode Mode = SearchMode::Tree>
+    [[nodiscard]] std::shared_ptr<Node<State>> work_stealing_bfs(const Problem<State, TM> &problem) {
+        ThreadPool pool{std::thread::hardware_concurrency(), false};
+        return work_stealing_bfs<State, TM, Mode>(problem, pool);
+    }
+}
+
+#endif //PARALLEL_BFS_PROJECT_WORK_STEALING_BFS_H
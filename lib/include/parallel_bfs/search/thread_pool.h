@@ -0,0 +1,233 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_THREAD_POOL_H
+#define PARALLEL_BFS_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <string>
+#include "placement.h"
+#include "search_stats.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace parallel_bfs::detail {
+    /// Type-erased, move-only callable (std::function requires copyable targets, which rules out packaged_task).
+    class UniqueTask {
+    public:
+        UniqueTask() = default;
+
+        template<typename F>
+        explicit UniqueTask(F &&f) : _impl{std::make_unique<Impl<std::decay_t<F>>>(std::forward<F>(f))} {}
+
+        void operator()() { _impl->run(); }
+
+        explicit operator bool() const noexcept { return _impl != nullptr; }
+
+    private:
+        struct Base {
+            virtual ~Base() = default;
+
+            virtual void run() = 0;
+        };
+
+        template<typename F>
+        struct Impl final : Base {
+            explicit Impl(F &&f) : f{std::move(f)} {}
+
+            explicit Impl(const F &f) : f{f} {}
+
+            void run() override { f(); }
+
+            F f;
+        };
+
+        std::unique_ptr<Base> _impl{nullptr};
+    };
+
+
+    inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+
+    /// Number of CPUs that the process is allowed to run on.
+    inline unsigned int available_cpus() noexcept {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 0)
+            return static_cast<unsigned int>(CPU_COUNT(&allowed));
+#endif
+        const unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Fixed-size pool of persistent worker threads.
+     *
+     * Creating threads dominates the running time of small searches, so parallel strategies can take a pool as a
+     * parameter and submit their tasks to it instead. Workers are optionally pinned to different CPUs (see
+     * PlacementPolicy), and they spin for a short while before going to sleep, so a task submitted right after the
+     * previous one finished starts without a kernel round trip. Spinning is disabled when there are more workers than
+     * CPUs, since it would only take CPU time away from the workers that have something to do.
+     *
+     * Workers pin themselves before running any task, so the memory that they allocate for a search (e.g. their node
+     * arenas) is placed in their own NUMA node. Tasks can ask for that node with current_node(), for instance to
+     * prefer work from the same socket.
+     *
+     * Some strategies need all of their tasks to run at the same time (e.g. they synchronize with barriers), so they
+     * submit exactly size() tasks. Therefore, a pool should only run one search at a time.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned int num_threads, PlacementPolicy placement, unsigned int spin_iterations = 4096)
+                : _spin_iterations{num_threads <= detail::available_cpus() ? spin_iterations : 0} {
+            if (num_threads == 0) num_threads = 1;
+            const auto topology = detail::CpuTopology::detect();
+            _num_nodes = topology.num_nodes();
+            _threads.reserve(num_threads);
+            for (const detail::CpuSlot slot: topology.place(num_threads, placement)) {
+                _threads.emplace_back([this, slot, id = _threads.size()] {
+                    if (slot.cpu >= 0) detail::pin_current_thread(slot.cpu);
+                    detail::current_numa_node = slot.node;
+                    detail::name_trace_thread("Worker " + std::to_string(id));
+                    worker_loop();
+                });
+            }
+        }
+
+        /// Workers are pinned with PlacementPolicy::Compact if @pin_threads is true.
+        explicit ThreadPool(unsigned int num_threads = std::thread::hardware_concurrency(), bool pin_threads = true, unsigned int spin_iterations = 4096)
+                : ThreadPool{num_threads, pin_threads ? PlacementPolicy::Compact : PlacementPolicy::None, spin_iterations} {}
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock{_mutex};
+                _stop = true;
+            }
+            _condition.notify_all();
+            for (auto &thread: _threads) thread.join();
+        }
+
+        [[nodiscard]] unsigned int size() const noexcept { return static_cast<unsigned int>(_threads.size()); }
+
+        /// Number of NUMA nodes with CPUs available to the process (1 if the topology is unknown).
+        [[nodiscard]] unsigned int num_nodes() const noexcept { return _num_nodes; }
+
+        /// NUMA node of the worker that calls this method (in [0, num_nodes())). Always 0 outside of the workers.
+        [[nodiscard]] static unsigned int current_node() noexcept { return detail::current_numa_node; }
+
+        /// Runs f(args...) on some worker. The returned future holds the result (or the exception thrown).
+        template<typename F, typename... Args>
+        [[nodiscard]] std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> submit(F &&f, Args &&... args) {
+            using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+            std::packaged_task<Result()> task{[f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable {
+                const detail::BusyScope busy; // Ends before the future is ready, so it is not counted in the next search
+                return std::invoke(std::move(f), std::move(args)...);
+            }};
+            auto future = task.get_future();
+            enqueue(detail::UniqueTask{std::move(task)});
+            return future;
+        }
+
+        /// Runs f(i) for every i in [0, size()), one call per worker, and waits for all of them to finish.
+        /// Exceptions thrown by @f are rethrown (the first one) after all calls have finished.
+        template<typename F>
+        void run_on_all(F &&f) {
+            std::vector<std::future<void>> futures;
+            futures.reserve(size());
+            for (unsigned int i = 0; i < size(); ++i) futures.push_back(submit([&f, i] { f(i); }));
+            const detail::IdleScope waiting;
+            for (auto &future: futures) future.wait();
+            for (auto &future: futures) future.get();
+        }
+
+    private:
+        void enqueue(detail::UniqueTask task) {
+            bool wake_up;
+            {
+                std::lock_guard lock{_mutex};
+                _tasks.push_back(std::move(task));
+                _queued.fetch_add(1, std::memory_order_release);
+                wake_up = _sleeping > 0;
+            }
+            if (wake_up) _condition.notify_one();
+        }
+
+        bool try_pop(detail::UniqueTask &task) {
+            std::lock_guard lock{_mutex};
+            if (_tasks.empty()) return false;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void worker_loop() {
+            while (true) {
+                detail::UniqueTask task;
+
+                // Spin first: searches are usually submitted back to back
+                for (unsigned int i = 0; i < _spin_iterations && !task; ++i) {
+                    if (_queued.load(std::memory_order_acquire) > 0) try_pop(task);
+                    else detail::cpu_relax();
+                }
+
+                if (!task) {
+                    std::unique_lock lock{_mutex};
+                    ++_sleeping;
+                    _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+                    --_sleeping;
+                    if (_tasks.empty()) return; // Stopped and nothing left to do
+                    task = std::move(_tasks.front());
+                    _tasks.pop_front();
+                    _queued.fetch_sub(1, std::memory_order_relaxed);
+                }
+
+                task();
+            }
+        }
+
+        const unsigned int _spin_iterations;
+        unsigned int _num_nodes{1};
+        std::vector<std::thread> _threads{};
+        std::deque<detail::UniqueTask> _tasks{};
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::atomic<std::size_t> _queued{0};
+        unsigned int _sleeping{0};
+        bool _stop{false};
+    };
+}
+
+#endif //PARALLEL_BFS_THREAD_POOL_H
@@ -0,0 +1,217 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_TRACE_H
+#define PARALLEL_BFS_TRACE_H
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/// Search events are only recorded if PARALLEL_BFS_ENABLE_TRACE is defined to a non-zero value (see the
+/// PARALLEL_BFS_ENABLE_TRACE option of CMake). Otherwise, every hook below is empty and compiled away.
+#ifndef PARALLEL_BFS_ENABLE_TRACE
+#define PARALLEL_BFS_ENABLE_TRACE 0
+#endif
+
+
+namespace parallel_bfs {
+    inline constexpr bool search_trace_enabled = PARALLEL_BFS_ENABLE_TRACE != 0;
+
+
+    /// Something that a thread did during a search. Times are relative to the start of the search.
+    struct TraceEvent {
+        const char *name;             ///< A string literal, e.g. "bfs" or "wait"
+        std::chrono::nanoseconds start;
+        std::chrono::nanoseconds duration; ///< Negative for instant events
+        std::uint64_t arg;            ///< Meaning depends on the event (e.g. the size of the frontier)
+
+        [[nodiscard]] bool instant() const noexcept { return duration.count() < 0; }
+    };
+
+
+    /// Events of one thread, in the order in which they ended.
+    struct ThreadTrace {
+        unsigned int thread_id;  ///< Stable for the whole life of the thread
+        std::string thread_name;
+        std::vector<TraceEvent> events;
+        std::uint64_t dropped;   ///< Oldest events overwritten because the buffer was full
+    };
+}
+
+
+namespace parallel_bfs::detail {
+    using trace_clock = std::chrono::steady_clock;
+
+
+    /// Ring buffer with the last @capacity events of a thread. Only that thread writes it, without locks or
+    /// read-modify-write operations; the events are read between searches, once the thread has finished its work.
+    class TraceBuffer {
+    public:
+        static constexpr std::size_t capacity = 1 << 15;
+
+        explicit TraceBuffer(unsigned int id) : _id{id}, _name{"Thread " + std::to_string(id)} {}
+
+        void record(const char *name, trace_clock::time_point start, std::int64_t duration_ns, std::uint64_t arg) noexcept {
+            const std::uint64_t head = _head.load(std::memory_order_relaxed);
+            _events[head % capacity] = Slot{name, start.time_since_epoch().count(), duration_ns, arg};
+            _head.store(head + 1, std::memory_order_release);
+        }
+
+        void set_name(std::string name) {
+            std::lock_guard lock{_name_mutex};
+            _name = std::move(name);
+        }
+
+        void clear() noexcept { _tail = _head.load(std::memory_order_acquire); }
+
+        /// Events since the last clear(), with times relative to @origin.
+        [[nodiscard]] ThreadTrace drain(trace_clock::time_point origin) {
+            const std::uint64_t head = _head.load(std::memory_order_acquire);
+            const std::uint64_t first = std::max(_tail, head > capacity ? head - capacity : 0);
+            ThreadTrace trace{_id, {}, {}, first - _tail};
+            {
+                std::lock_guard lock{_name_mutex};
+                trace.thread_name = _name;
+            }
+            trace.events.reserve(head - first);
+            for (std::uint64_t i = first; i < head; ++i) {
+                const Slot &slot = _events[i % capacity];
+                const trace_clock::time_point start{trace_clock::duration{slot.start}};
+                trace.events.push_back(TraceEvent{slot.name, std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin),
+                                                  std::chrono::nanoseconds{slot.duration_ns}, slot.arg});
+            }
+            _tail = head;
+            return trace;
+        }
+
+    private:
+        struct Slot {
+            const char *name;
+            trace_clock::rep start;
+            std::int64_t duration_ns;
+            std::uint64_t arg;
+        };
+
+        const unsigned int _id;
+        std::string _name;
+        std::mutex _name_mutex;
+        std::uint64_t _tail{0}; // Only used by the reader
+        std::atomic<std::uint64_t> _head{0};
+        std::array<Slot, capacity> _events; // Not initialized, so that only the pages that are used are allocated
+    };
+
+
+    /// Buffers of all the threads that have recorded an event. Buffers are kept after their thread exits, until the
+    /// end of the next collect().
+    class TraceRegistry {
+    public:
+        [[nodiscard]] static TraceRegistry &instance() {
+            static TraceRegistry registry;
+            return registry;
+        }
+
+        [[nodiscard]] std::shared_ptr<TraceBuffer> add() {
+            std::lock_guard lock{_mutex};
+            auto buffer = std::make_shared<TraceBuffer>(_next_id++);
+            _buffers.push_back(buffer);
+            return buffer;
+        }
+
+        void reset() {
+            std::lock_guard lock{_mutex};
+            std::erase_if(_buffers, [](const std::shared_ptr<TraceBuffer> &buffer) { return buffer.use_count() == 1; }); // Exited
+            for (const auto &buffer: _buffers) buffer->clear();
+            _origin = trace_clock::now();
+        }
+
+        [[nodiscard]] std::vector<ThreadTrace> collect() {
+            std::lock_guard lock{_mutex};
+            std::vector<ThreadTrace> traces;
+            for (const auto &buffer: _buffers) {
+                ThreadTrace trace = buffer->drain(_origin);
+                if (!trace.events.empty() || trace.dropped > 0) traces.push_back(std::move(trace));
+            }
+            return traces;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<TraceBuffer>> _buffers{};
+        unsigned int _next_id{0};
+        trace_clock::time_point _origin{trace_clock::now()};
+    };
+
+
+    [[nodiscard]] inline TraceBuffer &thread_trace() {
+        thread_local const std::shared_ptr<TraceBuffer> buffer = TraceRegistry::instance().add();
+        return *buffer;
+    }
+
+
+    /// Names the calling thread in the traces (e.g. "Worker 3").
+    inline void name_trace_thread([[maybe_unused]] const std::string &name) {
+        if constexpr (search_trace_enabled) thread_trace().set_name(name);
+    }
+
+    /// Records an event without duration, e.g. "stop observed". @name must be a string literal.
+    inline void trace_instant([[maybe_unused]] const char *name, [[maybe_unused]] std::uint64_t arg = 0) noexcept {
+        if constexpr (search_trace_enabled) thread_trace().record(name, trace_clock::now(), -1, arg);
+    }
+
+    /// Records an event that lasted from @start until now. @name must be a string literal.
+    inline void trace_span([[maybe_unused]] const char *name, [[maybe_unused]] trace_clock::time_point start, [[maybe_unused]] std::uint64_t arg = 0) noexcept {
+        if constexpr (search_trace_enabled) {
+            const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(trace_clock::now() - start);
+            thread_trace().record(name, start, duration.count(), arg);
+        }
+    }
+
+
+    /// Records its scope as an event called @name (a string literal).
+    class TraceScope {
+    public:
+        explicit TraceScope([[maybe_unused]] const char *name, [[maybe_unused]] std::uint64_t arg = 0) noexcept {
+            if constexpr (search_trace_enabled) {
+                _name = name;
+                _arg = arg;
+                _start = trace_clock::now();
+            }
+        }
+
+        TraceScope(const TraceScope &) = delete;
+
+        TraceScope &operator=(const TraceScope &) = delete;
+
+        ~TraceScope() { trace_span(_name, _start, _arg); }
+
+    private:
+        const char *_name{nullptr};
+        std::uint64_t _arg{0};
+        trace_clock::time_point _start{};
+    };
+}
+
+
+namespace parallel_bfs {
+    /// Discards the events recorded so far, and starts timing a new search. Does nothing if tracing is disabled.
+    inline void reset_search_trace() {
+        if constexpr (search_trace_enabled) detail::TraceRegistry::instance().reset();
+    }
+
+    /// Events of every thread since the last reset_search_trace(). Must be called once the search has finished, when
+    /// no thread is recording events. Empty if tracing is disabled.
+    [[nodiscard]] inline std::vector<ThreadTrace> collect_search_trace() {
+        if constexpr (search_trace_enabled) return detail::TraceRegistry::instance().collect();
+        else return {};
+    }
+}
+
+#endif //PARALLEL_BFS_TRACE_H
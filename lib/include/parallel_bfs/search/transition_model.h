@@ -6,6 +6,8 @@
 #define PARALLEL_BFS_TRANSITION_MODEL_H
 
 #include <vector>
+#include <concepts>
+#include <utility>
 #include "state.h"
 
 namespace parallel_bfs {
@@ -39,6 +41,37 @@ namespace parallel_bfs {
 
         [[nodiscard]] virtual State result(const State &state, const Action &action) const = 0;
     };
+
+
+    /**
+     * @brief Non-virtual (CRTP) successor generation API.
+     *
+     * Transition models can derive from this class, in addition to TransitionModel, to let the search strategies
+     * generate successors without virtual calls nor temporary vectors. The derived class must implement:
+     *
+     *     template<typename F> void visit_successors(const State &state, F &&visitor) const;
+     *
+     * which invokes visitor(State &&next, int cost) once per successor. The virtual next_states() remains available
+     * as a fallback for models that do not implement this API.
+     */
+    template<typename Derived, Searchable State>
+    class SuccessorGenerator {
+    public:
+        template<std::invocable<State &&, int> F>
+        void for_each_successor(const State &state, F &&visitor) const {
+            static_cast<const Derived &>(*this).visit_successors(state, std::forward<F>(visitor));
+        }
+
+        /// Same as next_states(), but writes into @buffer, whose capacity is reused between calls.
+        void next_states_into(const State &state, std::vector<std::pair<State, int>> &buffer) const {
+            buffer.clear();
+            for_each_successor(state, [&buffer](State &&next, int cost) { buffer.emplace_back(std::move(next), cost); });
+        }
+    };
+
+
+    template<typename TM, typename State>
+    concept StaticSuccessorGenerator = std::derived_from<TM, SuccessorGenerator<TM, State>>;
 }
 
 #endif //PARALLEL_BFS_TRANSITION_MODEL_H
@@ -0,0 +1,201 @@
+//
+// Created by alejandro on 18/10/26.
+//
+
+#ifndef PARALLEL_BFS_WORKLOAD_H
+#define PARALLEL_BFS_WORKLOAD_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+
+namespace parallel_bfs::detail {
+    [[nodiscard]] constexpr std::uint64_t mix64(std::uint64_t x) noexcept { // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+
+    /// Busy loop whose body cannot be removed by the compiler, but does not touch memory nor read the clock.
+    inline void spin(std::uint64_t iterations) noexcept {
+        for (std::uint64_t i = 0; i < iterations; ++i) std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+
+    /// Number of spin() iterations per nanosecond in this machine. Measured once (a few milliseconds) on first use.
+    [[nodiscard]] inline double spin_iterations_per_ns() {
+        static const double rate = [] {
+            using clock = std::chrono::steady_clock;
+            std::uint64_t iterations = 1 << 16;
+            while (true) { // Grow the sample until it is long enough for the clock resolution not to matter
+                const auto start = clock::now();
+                spin(iterations);
+                if (clock::now() - start >= std::chrono::milliseconds{2}) break;
+                iterations *= 2;
+            }
+
+            double best_ns = std::numeric_limits<double>::max();
+            for (int repetition = 0; repetition < 3; ++repetition) { // The fastest run is the least disturbed one
+                const auto start = clock::now();
+                spin(iterations);
+                const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+                best_ns = std::min(best_ns, elapsed.count());
+            }
+            return static_cast<double>(iterations) / best_ns;
+        }();
+        return rate;
+    }
+
+
+    [[nodiscard]] inline std::uint64_t spin_iterations_for(std::chrono::nanoseconds duration) {
+        return static_cast<std::uint64_t>(std::llround(spin_iterations_per_ns() * static_cast<double>(duration.count())));
+    }
+}
+
+
+namespace parallel_bfs {
+    /**
+     * @brief Cost model of a goal test.
+     *
+     * Problem::is_goal() runs the workload of the problem (if any) before checking the goal set, to simulate problems
+     * with expensive goal tests. Implementations must be thread-safe, since all threads share the same instance.
+     */
+    class WorkloadModel {
+    public:
+        virtual ~WorkloadModel() = default;
+
+        /// Simulates goal-testing a state whose hash is @state_hash.
+        virtual void run(std::size_t state_hash) const noexcept = 0;
+
+        /// Short identifier of the model and its parameters (e.g. used in the name of log files).
+        [[nodiscard]] virtual std::string label() const = 0;
+    };
+
+
+    /// Busy wait of a fixed duration. The number of iterations is calibrated once, so the clock is never read.
+    class SpinWorkload final : public WorkloadModel {
+    public:
+        explicit SpinWorkload(std::chrono::nanoseconds duration)
+                : _duration{duration}, _iterations{detail::spin_iterations_for(duration)} {}
+
+        void run(std::size_t) const noexcept override { detail::spin(_iterations); }
+
+        [[nodiscard]] std::string label() const override {
+            return "delay" + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(_duration).count());
+        }
+
+    private:
+        std::chrono::nanoseconds _duration;
+        std::uint64_t _iterations;
+    };
+
+
+    /// CPU-bound kernel: a dependent chain of integer and floating point operations, seeded with the state.
+    class ComputeWorkload final : public WorkloadModel {
+    public:
+        explicit ComputeWorkload(std::uint64_t iterations) : _iterations{iterations} {}
+
+        void run(std::size_t state_hash) const noexcept override {
+            std::uint64_t x = detail::mix64(state_hash) | 1;
+            double y = 1.0;
+            for (std::uint64_t i = 0; i < _iterations; ++i) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                y = y * 0.999999 + static_cast<double>(x & 0xff);
+            }
+            [[maybe_unused]] volatile double sink = y + static_cast<double>(x);
+        }
+
+        [[nodiscard]] std::string label() const override { return "compute" + std::to_string(_iterations); }
+
+    private:
+        std::uint64_t _iterations;
+    };
+
+
+    /**
+     * @brief Memory-bound kernel: a chain of dependent loads through a random cyclic permutation of cache lines.
+     *
+     * With a buffer larger than the last level cache, every access is a cache miss, so the goal test is bound by
+     * memory latency (and bandwidth, when many threads run it). The buffer is built once and only read afterwards.
+     */
+    class MemoryWorkload final : public WorkloadModel {
+    public:
+        explicit MemoryWorkload(std::size_t buffer_bytes, std::uint64_t accesses, std::uint64_t seed = 0)
+                : _lines(std::max<std::size_t>(buffer_bytes / sizeof(CacheLine), 2)), _accesses{accesses} {
+            if (_lines.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::invalid_argument("The memory workload buffer is too large.");
+
+            // Sattolo's algorithm: a random permutation with a single cycle, so the chain never gets stuck in a loop
+            std::vector<std::uint32_t> order(_lines.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::mt19937_64 engine{seed};
+            for (std::size_t i = order.size() - 1; i > 0; --i)
+                std::swap(order[i], order[std::uniform_int_distribution<std::size_t>{0, i - 1}(engine)]);
+            for (std::size_t i = 0; i < order.size(); ++i) _lines[order[i]].next = order[(i + 1) % order.size()];
+        }
+
+        void run(std::size_t state_hash) const noexcept override {
+            std::uint32_t line = static_cast<std::uint32_t>(detail::mix64(state_hash) % _lines.size());
+            for (std::uint64_t i = 0; i < _accesses; ++i) line = _lines[line].next;
+            [[maybe_unused]] volatile std::uint32_t sink = line;
+        }
+
+        [[nodiscard]] std::string label() const override {
+            return "memory" + std::to_string(_lines.size() * sizeof(CacheLine) >> 20) + "M_" + std::to_string(_accesses);
+        }
+
+    private:
+        struct alignas(64) CacheLine {
+            std::uint32_t next;
+        };
+
+        std::vector<CacheLine> _lines;
+        std::uint64_t _accesses;
+    };
+
+
+    /**
+     * @brief Busy wait whose duration depends on the state, drawn from a distribution with the given mean.
+     *
+     * The duration is a deterministic function of the state hash, so every algorithm (and every run) pays the same
+     * cost for the same state, and the comparison between algorithms stays fair.
+     */
+    class VariableWorkload final : public WorkloadModel {
+    public:
+        enum class Distribution { Uniform, Exponential };
+
+        explicit VariableWorkload(std::chrono::nanoseconds mean, Distribution distribution)
+                : _mean{mean}, _mean_iterations{static_cast<double>(detail::spin_iterations_for(mean))}, _distribution{distribution} {}
+
+        void run(std::size_t state_hash) const noexcept override {
+            const double u = static_cast<double>(detail::mix64(state_hash) >> 11) * 0x1.0p-53; // Uniform in [0, 1)
+            const double factor = _distribution == Distribution::Uniform ? 2.0 * u : -std::log1p(-u);
+            detail::spin(static_cast<std::uint64_t>(factor * _mean_iterations));
+        }
+
+        [[nodiscard]] std::string label() const override {
+            return std::string{"variable"} + (_distribution == Distribution::Uniform ? "Uniform" : "Exponential")
+                   + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(_mean).count());
+        }
+
+    private:
+        std::chrono::nanoseconds _mean;
+        double _mean_iterations;
+        Distribution _distribution;
+    };
+}
+
+#endif //PARALLEL_BFS_WORKLOAD_H
@@ -3,19 +3,35 @@ import os
 import pandas as pd
 
 
+# Descriptive names of the algorithms, as used in data.csv
+ALGORITHM_MAP = {
+    "AnyOfBFS": "C++ any_of",
+    "AsyncBFS": "Recursive async",
+    "TasksBFS": "Using C++ tasks",
+    "ForeachBFS": "Recursive C++ for_each",
+    "SyncBFS": "Sequential",
+    "AsyncStartBFS": "Using C++ async",
+    "MultithreadBFS": "Synchronization with thread director",
+    "ForeachStartBFS": "Using C++ for_each",
+    "ArenaSyncBFS": "Sequential with node arena",
+    "ArenaTasksBFS": "Using C++ tasks with node arenas",
+    "WorkStealingBFS": "Work stealing (Chase-Lev deques)",
+    "LevelSyncBFS": "Level-synchronous",
+    "SharedQueueBFS": "Shared lock-free frontier queue",
+    "LockedQueueBFS": "Shared frontier queue with a mutex",
+    "UniformCostSearch": "Sequential uniform-cost search",
+    "HDAStar": "Hash-distributed A*",
+    "IDDFS": "Iterative deepening DFS",
+    "ParallelIDDFS": "Parallel iterative deepening DFS",
+    "BidirectionalBFS": "Bidirectional BFS",
+    "ParallelBidirectionalBFS": "Parallel bidirectional BFS",
+    "AutoTuned": "Auto-tuned strategy",
+    "TuningExploration": "Auto-tuner exploration",
+}
+
+
 # Function to read data from a single input file and return a DataFrame
 def create_dataframe(input_path: str, problem_type: str, goal_check_delay: int) -> pd.DataFrame:
-    algorithm_map = {
-        "AnyOfBFS": "C++ any_of",
-        "AsyncBFS": "Recursive async",
-        "TasksBFS": "Using C++ tasks",
-        "ForeachBFS": "Recursive C++ for_each",
-        "SyncBFS": "Sequential",
-        "AsyncStartBFS": "Using C++ async",
-        "MultithreadBFS": "Synchronization with thread director",
-        "ForeachStartBFS": "Using C++ for_each",
-    }
-
     # Initialize an empty dictionary to store results
     results = {'problem_type': [], 'goal_check_delay': [], 'problem_number': [], 'execution_time': [], 'algorithm_name': [], 'solution_found': []}
 
@@ -37,11 +53,16 @@ def create_dataframe(input_path: str, problem_type: str, goal_check_delay: int)
 
             # Check if the line contains execution time for an algorithm
             elif ":" in line:
-                # Split the line into algorithm name and execution time
-                parts = line.strip().split(":")
-                algorithm_name = parts[0]
-                algorithm_name = algorithm_map[algorithm_name]
-                execution_time = float(parts[1].split()[0])
+                # Split the line into algorithm name and execution time. The algorithms of --tune add their choice
+                # in parentheses after the name (e.g. "AutoTuned (WorkStealingBFS, threads: 8, granularity: 4): 12.3 ms")
+                line = line.strip()
+                if "): " in line:
+                    algorithm_name, rest = line.rsplit("): ", 1)
+                    algorithm_name = algorithm_name.split(" (")[0]
+                else:
+                    algorithm_name, rest = line.split(":", 1)
+                algorithm_name = ALGORITHM_MAP.get(algorithm_name, algorithm_name)
+                execution_time = float(rest.split()[0])
                 solution_found = False if "No solution found!" in line else True
                 
                 # Store the execution time in the corresponding position of the list
@@ -57,6 +78,19 @@ def create_dataframe(input_path: str, problem_type: str, goal_check_delay: int)
     return pd.DataFrame(results)
 
 
+# Function to read the CSV file written next to each log file (results_*.csv) and return a DataFrame.
+# The file already has the columns of data.csv, plus some columns about the benchmark that are kept.
+def create_dataframe_from_csv(input_path: str, problem_type: str | None = None) -> pd.DataFrame:
+    df = pd.read_csv(input_path)
+    df['algorithm_name'] = df['algorithm_name'].map(lambda name: ALGORITHM_MAP.get(name, name))
+    if problem_type is not None:
+        df['problem_type'] = problem_type
+
+    print(f"Processed {len(df)} results from {input_path}")
+    print(f"Outliers: {int(df['outlier'].sum())}")
+    return df
+
+
 # Function to update the existing DataFrame with new data
 def update_dataframe(existing_df: pd.DataFrame, new_data_df: pd.DataFrame):
     if existing_df is None:
@@ -72,7 +106,7 @@ def update_dataframe(existing_df: pd.DataFrame, new_data_df: pd.DataFrame):
 # Define the path to the raw data file
 PROBLEM_TYPE = "unbalanced"
 GOAL_CHECK_DELAY = 100
-INPUT_PATH = "problems/unbalanced/results_2024-03-04-16:47:02.log"
+INPUT_PATH = "problems/unbalanced/results_2024-03-04-16:47:02.log" # Either a .log or a .csv file
 DATAFRAME_PATH = "data.csv"
 
 # Load the existing DataFrame from the file (if it exists)
@@ -81,7 +115,10 @@ if os.path.exists(DATAFRAME_PATH):
     df = pd.read_csv(DATAFRAME_PATH)
 
 # Create a DataFrame from the raw data file
-new_df = create_dataframe(INPUT_PATH, PROBLEM_TYPE, GOAL_CHECK_DELAY)
+if INPUT_PATH.endswith(".csv"):
+    new_df = create_dataframe_from_csv(INPUT_PATH, PROBLEM_TYPE)
+else:
+    new_df = create_dataframe(INPUT_PATH, PROBLEM_TYPE, GOAL_CHECK_DELAY)
 
 # Update the existing DataFrame with the new data
 updated_df = update_dataframe(df, new_df)
@@ -17,3 +17,11 @@ done
 for delay in {1..20..1}; do
   ./main.out --solve -d "$delay" "$problems_base/small"
 done
+
+# Solve small problems with CPU-bound and memory-bound goal tests
+for iterations in 1000 10000 100000; do
+  ./main.out --solve -w "compute:$iterations" "$problems_base/small"
+done
+for accesses in 10 100 1000; do
+  ./main.out --solve -w "memory:256:$accesses" "$problems_base/small"
+done
@@ -3,9 +3,11 @@
 #include <iostream>
 #include <unordered_set>
 #include <string>
+#include "../include/convert.h"
 #include "../include/generator_config.h"
 #include "../include/generate.h"
 #include "../include/solve.h"
+#include "../include/workload_config.h"
 
 
 void show_help(const std::string& program_name){
@@ -19,14 +21,29 @@ void show_help(const std::string& program_name){
     "  -c, --config=FILE         Use the specified configuration file to modify generation behaviour.\n"
     "  -g, --generate            Generate problems but do not solve them, unless --solve is also specified.\n"
     "  -s, --solve               Solve problems but do not generate them, unless --generate is also specified.\n"
+    "  -C, --convert             Convert the YAML problems of DIRECTORY to the binary format, which is faster to load.\n"
+    "                            Problems are only generated or solved if --generate or --solve are also specified.\n"
     "  -n, --num-problems=NUM    Number of problems to generate/solve.\n"
     "  -d, --workload-delay=TIME Artificial delay (in microseconds) when checking goal to simulate workload.\n"
+    "  -w, --workload=SPEC       Goal-test workload model: spin:TIME, compute:ITERATIONS, memory:MIB:ACCESSES or\n"
+    "                            variable:TIME[:uniform|exponential] (TIME in microseconds). Not compatible with -d.\n"
+    "  -p, --placement=POLICY    Placement of the threads of the parallel algorithms: none (not pinned), compact\n"
+    "                            (fill a NUMA node before the next one, the default) or spread (round-robin among nodes).\n"
+    "  -r, --repetitions=NUM     Measured runs of each algorithm on each problem, in a new random order each time (1).\n"
+    "      --warmup=NUM          Untimed runs of each algorithm on each problem before the measured ones (0).\n"
+    "      --perf                Read hardware counters (cycles, instructions, cache and branch misses) and software\n"
+    "                            ones (context switches, CPU time) in each measured run. Counters that the system does\n"
+    "                            not allow (see /proc/sys/kernel/perf_event_paranoid) are left out.\n"
+    "      --tune[=FILE]         Also solve the problems with an auto-tuned algorithm, which samples each problem and\n"
+    "                            picks a strategy, number of threads and split granularity with the profile in FILE\n"
+    "                            (tuning_profile.yaml). The profile is then updated with the results of all the runs.\n"
     "  -h, --help                Display this help and exit.\n\n"
 
     "Examples:\n"
     "  " << program_name << " -c myconf.yaml data_dir   Use 'myconf.yaml' config file and perform --generate and --solve on 'data_dir'.\n"
     "  " << program_name << " --generate -n 10 .        Generate 10 problems in the current directory.\n"
-    "  " << program_name << " --solve dir1 dir2         Solve problems in directories 'dir1' and 'dir2'.\n";
+    "  " << program_name << " --solve dir1 dir2         Solve problems in directories 'dir1' and 'dir2'.\n"
+    "  " << program_name << " --convert --solve dir1    Convert the problems in 'dir1' to binary format and solve them.\n";
 }
 
 
@@ -34,9 +51,16 @@ struct Arguments {
     std::unordered_set<std::filesystem::path> directories;
     std::optional<unsigned int> num_problems;
     std::optional<std::chrono::microseconds> workload_delay;
+    std::optional<std::string> workload_spec;
+    std::optional<parallel_bfs::PlacementPolicy> placement;
+    std::optional<unsigned int> repetitions;
+    std::optional<unsigned int> warmup_rounds;
     std::optional<BasicTreeGeneratorConfig> config;
     bool call_generate = false;
     bool call_solve = false;
+    bool call_convert = false;
+    bool perf_counters = false;
+    std::optional<std::filesystem::path> tuning_profile;
     bool show_help = false;
 };
 
@@ -49,6 +73,14 @@ std::pair<std::string, std::optional<std::string>> key_value_split(const std::st
 }
 
 
+parallel_bfs::PlacementPolicy parse_placement(const std::string &policy) noexcept(false) {
+    if (policy == "none") return parallel_bfs::PlacementPolicy::None;
+    if (policy == "compact") return parallel_bfs::PlacementPolicy::Compact;
+    if (policy == "spread") return parallel_bfs::PlacementPolicy::Spread;
+    throw std::runtime_error{"Unknown placement policy: " + policy};
+}
+
+
 void check_directory(const std::filesystem::path &path) noexcept(false) {
     if (!std::filesystem::exists(path)) {
         std::filesystem::create_directories(path);
@@ -87,6 +119,12 @@ Arguments parse_arguments(int argc, char** argv) noexcept(false) {
 
         else if (full_arg == "--solve" || full_arg == "-s") args.call_solve = true;
 
+        else if (full_arg == "--convert" || full_arg == "-C") args.call_convert = true;
+
+        else if (full_arg == "--perf") args.perf_counters = true;
+
+        else if (arg_name == "--tune") args.tuning_profile = arg_value.value_or("tuning_profile.yaml");
+
         else if (arg_name == "--num-problems" || arg_name == "-n") {
             std::string n;
             if (arg_value.has_value()) n = arg_value.value();
@@ -105,12 +143,45 @@ Arguments parse_arguments(int argc, char** argv) noexcept(false) {
             args.workload_delay = std::chrono::microseconds{std::stoi(delay)};
         }
 
+        else if (arg_name == "--workload" || arg_name == "-w") {
+            if (arg_value.has_value()) args.workload_spec = arg_value.value();
+            else if (i + 1 < argc) args.workload_spec = argv[++i];
+            else throw std::runtime_error{"No workload specified for " + arg_name};
+        }
+
+        else if (arg_name == "--placement" || arg_name == "-p") {
+            std::string policy;
+            if (arg_value.has_value()) policy = arg_value.value();
+            else if (i + 1 < argc) policy = argv[++i];
+            else throw std::runtime_error{"No placement policy specified for " + arg_name};
+
+            args.placement = parse_placement(policy);
+        }
+
+        else if (arg_name == "--repetitions" || arg_name == "-r") {
+            std::string n;
+            if (arg_value.has_value()) n = arg_value.value();
+            else if (i + 1 < argc) n = argv[++i];
+            else throw std::runtime_error{"No number specified for " + arg_name};
+
+            args.repetitions = std::stoi(n);
+        }
+
+        else if (arg_name == "--warmup") {
+            std::string n;
+            if (arg_value.has_value()) n = arg_value.value();
+            else if (i + 1 < argc) n = argv[++i];
+            else throw std::runtime_error{"No number specified for " + arg_name};
+
+            args.warmup_rounds = std::stoi(n);
+        }
+
         else throw std::runtime_error{"Unknown argument: " + full_arg};
     }
 
     // Set default values
     if (args.directories.empty()) args.directories.insert(std::filesystem::current_path());
-    if (!(args.call_generate || args.call_solve)) args.call_generate = args.call_solve = true;
+    if (!(args.call_generate || args.call_solve || args.call_convert)) args.call_generate = args.call_solve = true;
 
     return args;
 }
@@ -119,14 +190,32 @@ Arguments parse_arguments(int argc, char** argv) noexcept(false) {
 void validate_arguments(const Arguments &args) noexcept(false) {
     std::ranges::for_each(args.directories, check_directory);
 
-    if (args.workload_delay.has_value() && !args.call_solve)
+    if ((args.workload_delay.has_value() || args.workload_spec.has_value()) && !args.call_solve)
         throw std::runtime_error{"Workload delay specified but no solving requested"};
 
+    if (args.placement.has_value() && !args.call_solve)
+        throw std::runtime_error{"Placement policy specified but no solving requested"};
+
+    if ((args.repetitions.has_value() || args.warmup_rounds.has_value()) && !args.call_solve)
+        throw std::runtime_error{"Repetitions specified but no solving requested"};
+
+    if (args.perf_counters && !args.call_solve)
+        throw std::runtime_error{"Performance counters requested but no solving requested"};
+
+    if (args.tuning_profile.has_value() && !args.call_solve)
+        throw std::runtime_error{"Tuning profile specified but no solving requested"};
+
+    if (args.repetitions.has_value() && args.repetitions.value() == 0)
+        throw std::runtime_error{"At least one repetition is needed"};
+
+    if (args.workload_delay.has_value() && args.workload_spec.has_value())
+        throw std::runtime_error{"Only one of --workload-delay and --workload can be specified"};
+
     if (args.config.has_value() && !args.call_generate)
         throw std::runtime_error{"Config file specified but no generation requested"};
 
-    if (args.workload_delay.has_value() && args.workload_delay.value().count() > 500)
-        throw std::runtime_error{"Workload delay too high (max 500 microseconds)"};
+    if (args.workload_delay.has_value() && args.workload_delay.value() > max_workload_delay)
+        throw std::runtime_error{"Workload delay too high (max " + std::to_string(max_workload_delay.count()) + " microseconds)"};
 }
 
 
@@ -150,8 +239,22 @@ int main(int argc, char** argv) {
         if (args.call_generate)
             std::ranges::for_each(args.directories, [args](const auto &p) {generate(p, args.num_problems, args.config); });
 
-        if (args.call_solve)
-            std::ranges::for_each(args.directories, [args](const auto &p) {solve(p, args.num_problems, args.workload_delay); });
+        if (args.call_convert)
+            std::ranges::for_each(args.directories, [&args](const auto &p) {convert(p, args.num_problems); });
+
+        if (args.call_solve) {
+            std::shared_ptr<const parallel_bfs::WorkloadModel> workload{nullptr};
+            if (args.workload_spec.has_value()) workload = parse_workload(args.workload_spec.value());
+            else if (args.workload_delay.value_or(std::chrono::microseconds{0}).count() > 0)
+                workload = std::make_shared<const parallel_bfs::SpinWorkload>(args.workload_delay.value());
+            BenchmarkConfig benchmark;
+            benchmark.repetitions = args.repetitions.value_or(benchmark.repetitions);
+            benchmark.warmup_rounds = args.warmup_rounds.value_or(benchmark.warmup_rounds);
+            benchmark.perf_counters = args.perf_counters;
+            benchmark.tuning_profile = args.tuning_profile;
+            const auto placement = args.placement.value_or(parallel_bfs::PlacementPolicy::Compact);
+            std::ranges::for_each(args.directories, [&args, &workload, placement, &benchmark](const auto &p) {solve(p, args.num_problems, workload, placement, benchmark); });
+        }
 
     } catch (const std::exception &e) {
         std::cerr << e.what() << "\n";